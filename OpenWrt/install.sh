@@ -27,6 +27,11 @@ echo "[3/5] 复制文件..."
 cp -f files/usr/lib/haut-network-guard/*.lua /usr/lib/haut-network-guard/
 cp -f files/etc/init.d/haut-network-guard /etc/init.d/
 cp -f files/etc/config/haut-network-guard /etc/config/
+# 已交叉编译的原生守护进程 (可选), 服务脚本会优先使用
+if [ -f native/haut-network-guard-lite ]; then
+    cp -f native/haut-network-guard-lite /usr/sbin/
+    chmod +x /usr/sbin/haut-network-guard-lite
+fi
 
 # 设置权限
 echo "[4/5] 设置权限..."
@@ -0,0 +1,60 @@
+#!/bin/sh
+# HAUT Network Guard - Lua 与原生守护进程资源占用对比
+# 用法: ./bench.sh [运行秒数] [原生程序路径]
+# 两个实现依次以当前 UCI 配置运行相同时长, 统计:
+#   - 每个检测周期的 CPU 时间 (含 logger/uci/curl/openssl 等子进程)
+#   - 主进程峰值 RSS (VmHWM)
+
+DURATION=${1:-300}
+NATIVE=${2:-/usr/sbin/haut-network-guard-lite}
+LUA_PROG=/usr/lib/haut-network-guard/main.lua
+CONFIG=/etc/config/haut-network-guard
+
+INTERVAL=$(uci -q get haut-network-guard.main.interval)
+INTERVAL=${INTERVAL:-30}
+# 首个周期在启动时立即执行
+CYCLES=$((DURATION / INTERVAL + 1))
+
+# /proc/<pid>/stat 的时间单位为 USER_HZ (Linux 上固定为 100)
+cpu_ticks() {
+    # 字段 14-17: utime stime cutime cstime; comm 可能含空格, 从 ')' 之后计数
+    sed 's/.*) //' "/proc/$1/stat" | awk '{ print $12 + $13 + $14 + $15 }'
+}
+
+peak_rss() {
+    awk '/^VmHWM:/ { print $2 }' "/proc/$1/status"
+}
+
+run_one() {
+    name=$1
+    shift
+    "$@" >/dev/null 2>&1 &
+    pid=$!
+    sleep "$DURATION"
+    ticks=$(cpu_ticks "$pid")
+    rss=$(peak_rss "$pid")
+    kill "$pid" 2>/dev/null
+    wait "$pid" 2>/dev/null
+    awk -v n="$name" -v t="$ticks" -v c="$CYCLES" -v r="$rss" 'BEGIN {
+        printf "%-8s %10.2f %10d %8d\n", n, t * 10 / c, r, c
+    }'
+}
+
+if [ ! -x "$NATIVE" ]; then
+    echo "错误: 未找到原生程序 $NATIVE"
+    exit 1
+fi
+
+# 避免与正在运行的服务同时登录
+RUNNING=0
+if /etc/init.d/haut-network-guard running 2>/dev/null; then
+    RUNNING=1
+    /etc/init.d/haut-network-guard stop
+fi
+
+echo "运行 ${DURATION} 秒/实现, 检测间隔 ${INTERVAL} 秒"
+printf "%-8s %10s %10s %8s\n" "impl" "cpu_ms/次" "rss_kb" "cycles"
+run_one lua /usr/bin/lua "$LUA_PROG"
+run_one native "$NATIVE" -c "$CONFIG"
+
+[ "$RUNNING" = 1 ] && /etc/init.d/haut-network-guard start
@@ -0,0 +1,101 @@
+#include "eventloop.h"
+#include <cerrno>
+#include <ctime>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+EventLoop::EventLoop() { m_epollFd = ::epoll_create1(EPOLL_CLOEXEC); }
+
+EventLoop::~EventLoop() {
+  if (m_epollFd >= 0)
+    ::close(m_epollFd);
+}
+
+int64_t EventLoop::nowMs() {
+  timespec ts;
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+bool EventLoop::watch(int fd, uint32_t events, IoHandler handler) {
+  epoll_event ev = {};
+  ev.events = events;
+  ev.data.fd = fd;
+
+  const bool known = m_handlers.count(fd) > 0;
+  if (::epoll_ctl(m_epollFd, known ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd,
+                  &ev) < 0)
+    return false;
+  m_handlers[fd] = std::move(handler);
+  return true;
+}
+
+void EventLoop::unwatch(int fd) {
+  if (m_handlers.erase(fd) == 0)
+    return;
+  ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+int EventLoop::addTimer(int64_t delayMs, std::function<void()> callback) {
+  const int id = ++m_nextTimerId;
+  const int64_t due = nowMs() + (delayMs > 0 ? delayMs : 0);
+  m_timers.emplace(TimerKey(due, id), std::move(callback));
+  m_timerDue.emplace(id, due);
+  return id;
+}
+
+void EventLoop::cancelTimer(int id) {
+  auto it = m_timerDue.find(id);
+  if (it == m_timerDue.end())
+    return;
+  m_timers.erase(TimerKey(it->second, id));
+  m_timerDue.erase(it);
+}
+
+int EventLoop::nextTimeoutMs() const {
+  if (m_timers.empty())
+    return -1;
+  const int64_t wait = m_timers.begin()->first.first - nowMs();
+  if (wait <= 0)
+    return 0;
+  return wait > 0x7fffffff ? 0x7fffffff : static_cast<int>(wait);
+}
+
+void EventLoop::runDueTimers() {
+  const int64_t now = nowMs();
+  while (!m_timers.empty() && m_timers.begin()->first.first <= now) {
+    // 先出队再执行, 回调中可以安全地添加或取消定时器
+    auto first = m_timers.begin();
+    m_timerDue.erase(first->first.second);
+    std::function<void()> callback = std::move(first->second);
+    m_timers.erase(first);
+    callback();
+  }
+}
+
+bool EventLoop::run() {
+  static const int MAX_EVENTS = 8;
+  epoll_event events[MAX_EVENTS];
+
+  m_running = true;
+  while (m_running) {
+    const int n = ::epoll_wait(m_epollFd, events, MAX_EVENTS, nextTimeoutMs());
+    ++m_wakeups;
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+
+    for (int i = 0; i < n && m_running; ++i) {
+      // 回调可能 unwatch 其它 fd, 每次都重新查找
+      auto it = m_handlers.find(events[i].data.fd);
+      if (it == m_handlers.end())
+        continue;
+      IoHandler handler = it->second;
+      handler(events[i].events);
+    }
+    runDueTimers();
+  }
+  return true;
+}
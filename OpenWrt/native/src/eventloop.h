@@ -0,0 +1,55 @@
+#ifndef EVENTLOOP_H
+#define EVENTLOOP_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <utility>
+
+// 单线程 epoll 事件循环: 文件描述符就绪回调 + 一次性定时器
+// 定时器不占用 fd, 由 epoll_wait 的超时驱动
+class EventLoop {
+public:
+  typedef std::function<void(uint32_t events)> IoHandler;
+
+  EventLoop();
+  ~EventLoop();
+  EventLoop(const EventLoop &) = delete;
+  EventLoop &operator=(const EventLoop &) = delete;
+
+  bool isValid() const { return m_epollFd >= 0; }
+
+  // 单调时钟毫秒数
+  static int64_t nowMs();
+
+  // events 为 EPOLLIN/EPOLLOUT 等组合; 同一 fd 重复 watch 视为修改
+  bool watch(int fd, uint32_t events, IoHandler handler);
+  void unwatch(int fd);
+
+  int addTimer(int64_t delayMs, std::function<void()> callback);
+  void cancelTimer(int id);
+
+  // 运行直到 quit(), 返回 false 表示 epoll 出错
+  bool run();
+  void quit() { m_running = false; }
+
+  // 实际执行的 epoll_wait 次数 (即进程被唤醒的次数)
+  uint64_t wakeups() const { return m_wakeups; }
+
+private:
+  void runDueTimers();
+  int nextTimeoutMs() const;
+
+  typedef std::pair<int64_t, int> TimerKey;
+
+  int m_epollFd = -1;
+  bool m_running = false;
+  int m_nextTimerId = 0;
+  uint64_t m_wakeups = 0;
+
+  std::map<int, IoHandler> m_handlers;
+  std::map<TimerKey, std::function<void()>> m_timers;
+  std::map<int, int64_t> m_timerDue;
+};
+
+#endif // EVENTLOOP_H
@@ -0,0 +1,207 @@
+#include "guard.h"
+#include "eventloop.h"
+#include "srun3k.h"
+#include "uciconfig.h"
+#include <cstdio>
+#include <cstdlib>
+#include <syslog.h>
+
+const int Guard::STATUS_TIMEOUT_MS = 5000;
+const int Guard::LOGIN_TIMEOUT_MS = 10000;
+
+namespace {
+
+std::string formatBytes(int64_t bytes) {
+  char buffer[32];
+  if (bytes < 1024)
+    std::snprintf(buffer, sizeof(buffer), "%lld B",
+                  static_cast<long long>(bytes));
+  else if (bytes < 1048576)
+    std::snprintf(buffer, sizeof(buffer), "%.2f KB", bytes / 1024.0);
+  else if (bytes < 1073741824)
+    std::snprintf(buffer, sizeof(buffer), "%.2f MB", bytes / 1048576.0);
+  else
+    std::snprintf(buffer, sizeof(buffer), "%.2f GB", bytes / 1073741824.0);
+  return buffer;
+}
+
+std::string formatTime(int64_t seconds) {
+  const int hours = static_cast<int>(seconds / 3600);
+  const int mins = static_cast<int>((seconds % 3600) / 60);
+  const int secs = static_cast<int>(seconds % 60);
+  char buffer[48];
+  if (hours > 0)
+    std::snprintf(buffer, sizeof(buffer), "%d小时%d分%d秒", hours, mins, secs);
+  else if (mins > 0)
+    std::snprintf(buffer, sizeof(buffer), "%d分%d秒", mins, secs);
+  else
+    std::snprintf(buffer, sizeof(buffer), "%d秒", secs);
+  return buffer;
+}
+
+// 从 JSON 文本中取 "key":"value" 或 "key":number, 与 api.lua 的匹配方式一致
+std::string jsonField(const std::string &body, const std::string &key) {
+  const std::string pattern = "\"" + key + "\":";
+  size_t pos = body.find(pattern);
+  if (pos == std::string::npos)
+    return std::string();
+  pos += pattern.size();
+  while (pos < body.size() && body[pos] == ' ')
+    ++pos;
+
+  if (pos < body.size() && body[pos] == '"') {
+    const size_t end = body.find('"', pos + 1);
+    return end == std::string::npos ? std::string()
+                                     : body.substr(pos + 1, end - pos - 1);
+  }
+  size_t end = pos;
+  while (end < body.size() && body[end] >= '0' && body[end] <= '9')
+    ++end;
+  return body.substr(pos, end - pos);
+}
+
+} // namespace
+
+GuardSettings GuardSettings::fromUci(const UciConfig &config) {
+  static const char SECTION[] = "main";
+  GuardSettings settings;
+  settings.enabled = config.getBool(SECTION, "enabled", settings.enabled);
+  settings.username = config.get(SECTION, "username");
+  settings.password = config.get(SECTION, "password");
+  settings.intervalSec =
+      config.getInt(SECTION, "interval", settings.intervalSec);
+  if (settings.intervalSec < 5)
+    settings.intervalSec = 5;
+  settings.acId = config.get(SECTION, "ac_id", settings.acId);
+  settings.statusUrl = config.get(SECTION, "status_url", settings.statusUrl);
+  settings.loginUrl = config.get(SECTION, "login_url", settings.loginUrl);
+  return settings;
+}
+
+Guard::Guard(EventLoop *loop) : m_loop(loop), m_http(loop) {}
+
+void Guard::setSettings(const GuardSettings &settings) {
+  m_settings = settings;
+
+  // 字段顺序与 portals.json 的 login_fields 一致
+  m_loginPrefix = "action=login&username=";
+  m_loginSuffix = "&ac_id=" + HttpClient::percentEncode(settings.acId) +
+                  "&drop=0&pop=1&type=10&n=117&mbytes=0&minutes=0"
+                  "&mac=" +
+                  HttpClient::percentEncode("02:00:00:00:00:00");
+}
+
+void Guard::start() {
+  stop();
+  m_running = true;
+  runCycle();
+}
+
+void Guard::stop() {
+  m_running = false;
+  m_http.abort();
+  if (m_timer) {
+    m_loop->cancelTimer(m_timer);
+    m_timer = 0;
+  }
+}
+
+void Guard::runCycle() {
+  m_timer = 0;
+  ++m_stats.cycles;
+
+  // JSONP 回调名与 Windows/Lua 版本一致, 时间戳仅用于绕过缓存
+  const std::string timestamp = std::to_string(EventLoop::nowMs());
+  const char separator =
+      m_settings.statusUrl.find('?') == std::string::npos ? '?' : '&';
+  const std::string url = m_settings.statusUrl + separator +
+                          "callback=jQuery_" + timestamp + "&_=" + timestamp;
+
+  m_http.get(url, STATUS_TIMEOUT_MS,
+             [this](const HttpClient::Response &response) {
+               onStatus(response);
+             });
+}
+
+bool Guard::parseStatus(const std::string &body, UserInfo *info) {
+  if (body.empty() || body.find("not_online") != std::string::npos)
+    return false;
+
+  info->username = jsonField(body, "user_name");
+  info->ip = jsonField(body, "online_ip");
+  info->bytes = std::atoll(jsonField(body, "sum_bytes").c_str());
+  info->seconds = std::atoll(jsonField(body, "sum_seconds").c_str());
+  return !info->username.empty() || !info->ip.empty();
+}
+
+void Guard::onStatus(const HttpClient::Response &response) {
+  UserInfo info;
+  if (response.ok && parseStatus(response.body, &info)) {
+    // 每个周期都写日志会刷满路由器的环形日志, 只在状态变化时用 info 级别
+    syslog(m_online ? LOG_DEBUG : LOG_INFO, "在线 - IP: %s, 流量: %s, 时长: %s",
+           info.ip.c_str(), formatBytes(info.bytes).c_str(),
+           formatTime(info.seconds).c_str());
+    m_online = true;
+    endCycle();
+    return;
+  }
+
+  if (!response.ok)
+    syslog(LOG_WARNING, "状态查询失败: %s", response.error.c_str());
+  if (m_online || m_firstCycle)
+    syslog(LOG_WARNING, "离线，尝试登录...");
+  m_online = false;
+  login();
+}
+
+void Guard::login() {
+  if (m_settings.username.empty() || m_settings.password.empty()) {
+    syslog(LOG_ERR, "未配置用户名或密码");
+    endCycle();
+    return;
+  }
+
+  ++m_stats.logins;
+  std::string body = m_loginPrefix;
+  body += HttpClient::percentEncode(
+      Srun3k::encryptUsername(m_settings.username));
+  body += "&password=";
+  body += HttpClient::percentEncode(
+      Srun3k::encryptPassword(m_settings.password));
+  body += m_loginSuffix;
+
+  m_http.post(m_settings.loginUrl, body, LOGIN_TIMEOUT_MS,
+              [this](const HttpClient::Response &response) {
+                onLogin(response);
+              });
+}
+
+void Guard::onLogin(const HttpClient::Response &response) {
+  if (!response.ok) {
+    ++m_stats.loginFailures;
+    syslog(LOG_ERR, "登录失败: 网络错误: %s", response.error.c_str());
+  } else if (response.body.find("login_ok") != std::string::npos ||
+             response.body.find("already_online") != std::string::npos) {
+    syslog(LOG_INFO, "登录成功");
+  } else {
+    ++m_stats.loginFailures;
+    // 未知错误保留简短的原始响应便于排查
+    std::string detail = response.body.substr(0, 200);
+    while (!detail.empty() &&
+           (detail.back() == '\n' || detail.back() == '\r' ||
+            detail.back() == ' '))
+      detail.pop_back();
+    syslog(LOG_ERR, "登录失败: %s",
+           detail.empty() ? "无响应内容" : detail.c_str());
+  }
+  endCycle();
+}
+
+void Guard::endCycle() {
+  m_firstCycle = false;
+  if (m_running)
+    m_timer = m_loop->addTimer(m_settings.intervalSec * 1000LL,
+                               [this]() { runCycle(); });
+  if (m_cycleCallback)
+    m_cycleCallback();
+}
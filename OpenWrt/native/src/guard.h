@@ -0,0 +1,85 @@
+#ifndef GUARD_H
+#define GUARD_H
+
+#include "httpclient.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+class EventLoop;
+class UciConfig;
+
+// 守护配置, 默认值与 Windows 版 portals.json 中的 haut 门户一致
+struct GuardSettings {
+  bool enabled = true;
+  std::string username;
+  std::string password;
+  int intervalSec = 30;
+  std::string acId = "1";
+  std::string statusUrl = "http://172.16.154.130/cgi-bin/rad_user_info";
+  std::string loginUrl = "http://172.16.154.130:69/cgi-bin/srun_portal";
+
+  // 读取 haut-network-guard.main.*
+  static GuardSettings fromUci(const UciConfig &config);
+};
+
+// 检测循环: 每个周期查询一次在线状态, 离线时以 SRUN3K 协议登录
+class Guard {
+public:
+  struct Stats {
+    uint64_t cycles = 0;
+    uint64_t logins = 0;
+    uint64_t loginFailures = 0;
+  };
+
+  explicit Guard(EventLoop *loop);
+
+  void setSettings(const GuardSettings &settings);
+  const GuardSettings &settings() const { return m_settings; }
+
+  void start(); // 立即开始一个检测周期
+  void stop();
+
+  const Stats &stats() const { return m_stats; }
+
+  // 每个检测周期结束时调用
+  void setCycleCallback(std::function<void()> callback) {
+    m_cycleCallback = std::move(callback);
+  }
+
+private:
+  struct UserInfo {
+    std::string username;
+    std::string ip;
+    int64_t bytes = 0;
+    int64_t seconds = 0;
+  };
+
+  void runCycle();
+  void onStatus(const HttpClient::Response &response);
+  void login();
+  void onLogin(const HttpClient::Response &response);
+  void endCycle();
+
+  static bool parseStatus(const std::string &body, UserInfo *info);
+
+  EventLoop *m_loop;
+  HttpClient m_http;
+  GuardSettings m_settings;
+  Stats m_stats;
+  std::function<void()> m_cycleCallback;
+
+  // 登录请求体中除用户名/密码外的固定部分, 随配置预先拼好
+  std::string m_loginPrefix;
+  std::string m_loginSuffix;
+
+  int m_timer = 0;
+  bool m_running = false;
+  bool m_online = false;
+  bool m_firstCycle = true;
+
+  static const int STATUS_TIMEOUT_MS;
+  static const int LOGIN_TIMEOUT_MS;
+};
+
+#endif // GUARD_H
@@ -0,0 +1,251 @@
+#include "httpclient.h"
+#include "eventloop.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+const char *const HttpClient::USER_AGENT = "HAUTNetworkGuard/1.3.5 OpenWrt";
+const size_t HttpClient::MAX_RESPONSE_SIZE = 64 * 1024;
+
+namespace {
+
+struct ParsedUrl {
+  std::string host;
+  int port = 80;
+  std::string target; // path + query
+};
+
+bool parseUrl(const std::string &url, ParsedUrl *out) {
+  static const char SCHEME[] = "http://";
+  if (url.compare(0, sizeof(SCHEME) - 1, SCHEME) != 0)
+    return false;
+
+  const size_t hostStart = sizeof(SCHEME) - 1;
+  size_t pathStart = url.find('/', hostStart);
+  if (pathStart == std::string::npos)
+    pathStart = url.size();
+
+  std::string authority = url.substr(hostStart, pathStart - hostStart);
+  const size_t colon = authority.rfind(':');
+  if (colon != std::string::npos) {
+    out->port = std::atoi(authority.c_str() + colon + 1);
+    authority.resize(colon);
+  }
+  if (authority.empty() || out->port <= 0 || out->port > 65535)
+    return false;
+
+  out->host = authority;
+  out->target = pathStart < url.size() ? url.substr(pathStart) : "/";
+  return true;
+}
+
+bool resolve(const ParsedUrl &url, sockaddr_in *addr) {
+  std::memset(addr, 0, sizeof(*addr));
+  addr->sin_family = AF_INET;
+  addr->sin_port = htons(static_cast<uint16_t>(url.port));
+  if (::inet_pton(AF_INET, url.host.c_str(), &addr->sin_addr) == 1)
+    return true;
+
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo *result = nullptr;
+  if (::getaddrinfo(url.host.c_str(), nullptr, &hints, &result) != 0 ||
+      !result)
+    return false;
+  addr->sin_addr = reinterpret_cast<sockaddr_in *>(result->ai_addr)->sin_addr;
+  ::freeaddrinfo(result);
+  return true;
+}
+
+} // namespace
+
+HttpClient::HttpClient(EventLoop *loop) : m_loop(loop) {}
+
+HttpClient::~HttpClient() { abort(); }
+
+void HttpClient::get(const std::string &url, int timeoutMs,
+                     Callback callback) {
+  start("GET", url, std::string(), timeoutMs, std::move(callback));
+}
+
+void HttpClient::post(const std::string &url, const std::string &body,
+                      int timeoutMs, Callback callback) {
+  start("POST", url, body, timeoutMs, std::move(callback));
+}
+
+std::string HttpClient::percentEncode(const std::string &value) {
+  // 与 QUrl::toPercentEncoding 一致: 只保留 RFC 3986 非保留字符
+  static const char HEX[] = "0123456789ABCDEF";
+  std::string encoded;
+  encoded.reserve(value.size() * 3);
+  for (unsigned char c : value) {
+    if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+        (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' ||
+        c == '~') {
+      encoded.push_back(static_cast<char>(c));
+    } else {
+      encoded.push_back('%');
+      encoded.push_back(HEX[c >> 4]);
+      encoded.push_back(HEX[c & 0x0F]);
+    }
+  }
+  return encoded;
+}
+
+void HttpClient::start(const std::string &method, const std::string &url,
+                       const std::string &body, int timeoutMs,
+                       Callback callback) {
+  abort();
+  m_callback = std::move(callback);
+
+  ParsedUrl parsed;
+  sockaddr_in addr;
+  if (!parseUrl(url, &parsed)) {
+    fail("无效的地址: " + url);
+    return;
+  }
+  if (!resolve(parsed, &addr)) {
+    fail("无法解析主机: " + parsed.host);
+    return;
+  }
+
+  m_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (m_fd < 0) {
+    fail(std::string("socket: ") + std::strerror(errno));
+    return;
+  }
+
+  m_out = method + " " + parsed.target + " HTTP/1.0\r\nHost: " + parsed.host;
+  if (parsed.port != 80)
+    m_out += ":" + std::to_string(parsed.port);
+  m_out += "\r\nUser-Agent: ";
+  m_out += USER_AGENT;
+  m_out += "\r\nConnection: close\r\n";
+  if (method == "POST") {
+    m_out += "Content-Type: application/x-www-form-urlencoded\r\n"
+             "Content-Length: " +
+             std::to_string(body.size()) + "\r\n";
+  }
+  m_out += "\r\n";
+  m_out += body;
+  m_outOffset = 0;
+  m_in.clear();
+  m_connected = false;
+
+  if (::connect(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 &&
+      errno != EINPROGRESS) {
+    fail(std::string("connect: ") + std::strerror(errno));
+    return;
+  }
+
+  m_loop->watch(m_fd, EPOLLOUT, [this](uint32_t events) { onEvents(events); });
+  m_timer = m_loop->addTimer(timeoutMs, [this]() {
+    m_timer = 0;
+    fail("请求超时");
+  });
+}
+
+void HttpClient::abort() {
+  if (m_timer) {
+    m_loop->cancelTimer(m_timer);
+    m_timer = 0;
+  }
+  if (m_fd >= 0) {
+    m_loop->unwatch(m_fd);
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
+
+void HttpClient::onEvents(uint32_t events) {
+  if (events & EPOLLOUT)
+    onWritable();
+  else if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+    onReadable();
+}
+
+void HttpClient::onWritable() {
+  if (!m_connected) {
+    int error = 0;
+    socklen_t len = sizeof(error);
+    ::getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &error, &len);
+    if (error != 0) {
+      fail(std::string("connect: ") + std::strerror(error));
+      return;
+    }
+    m_connected = true;
+  }
+
+  while (m_outOffset < m_out.size()) {
+    ssize_t sent = ::send(m_fd, m_out.data() + m_outOffset,
+                          m_out.size() - m_outOffset, MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return;
+      fail(std::string("send: ") + std::strerror(errno));
+      return;
+    }
+    m_outOffset += static_cast<size_t>(sent);
+  }
+
+  // 请求已全部写出, 转为等待响应
+  m_loop->watch(m_fd, EPOLLIN, [this](uint32_t events) { onEvents(events); });
+}
+
+void HttpClient::onReadable() {
+  char buffer[4096];
+  for (;;) {
+    ssize_t n = ::recv(m_fd, buffer, sizeof(buffer), 0);
+    if (n > 0) {
+      if (m_in.size() + static_cast<size_t>(n) > MAX_RESPONSE_SIZE) {
+        fail("响应过大");
+        return;
+      }
+      m_in.append(buffer, static_cast<size_t>(n));
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return;
+    if (n < 0) {
+      fail(std::string("recv: ") + std::strerror(errno));
+      return;
+    }
+    break; // 对端关闭, HTTP/1.0 以此结束响应
+  }
+
+  // 状态行: HTTP/1.x NNN ...
+  Response response;
+  const size_t headerEnd = m_in.find("\r\n\r\n");
+  if (m_in.compare(0, 5, "HTTP/") != 0 || headerEnd == std::string::npos) {
+    fail("响应格式错误");
+    return;
+  }
+  const size_t space = m_in.find(' ');
+  response.status =
+      space < headerEnd ? std::atoi(m_in.c_str() + space + 1) : 0;
+  response.ok = true;
+  response.body = m_in.substr(headerEnd + 4);
+  finish(std::move(response));
+}
+
+void HttpClient::finish(Response response) {
+  abort();
+  // 回调中可能立即发起下一个请求, 先取出回调
+  Callback callback = std::move(m_callback);
+  m_callback = nullptr;
+  if (callback)
+    callback(response);
+}
+
+void HttpClient::fail(const std::string &error) {
+  Response response;
+  response.error = error;
+  finish(std::move(response));
+}
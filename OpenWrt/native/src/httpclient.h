@@ -0,0 +1,59 @@
+#ifndef HTTPCLIENT_H
+#define HTTPCLIENT_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+class EventLoop;
+
+// 基于事件循环的最小 HTTP/1.0 客户端, 同一时间只处理一个请求
+// 门户地址均为 IP, 主机名解析 (getaddrinfo) 是阻塞的, 仅作兜底
+class HttpClient {
+public:
+  struct Response {
+    bool ok = false;   // 收到完整的 HTTP 响应
+    int status = 0;    // HTTP 状态码
+    std::string body;
+    std::string error; // ok 为 false 时的原因
+  };
+  typedef std::function<void(const Response &)> Callback;
+
+  explicit HttpClient(EventLoop *loop);
+  ~HttpClient();
+  HttpClient(const HttpClient &) = delete;
+  HttpClient &operator=(const HttpClient &) = delete;
+
+  // url 形如 http://host[:port]/path?query; body 非空时发送 POST
+  void get(const std::string &url, int timeoutMs, Callback callback);
+  void post(const std::string &url, const std::string &body, int timeoutMs,
+            Callback callback);
+
+  bool busy() const { return m_fd >= 0; }
+  void abort();
+
+  static std::string percentEncode(const std::string &value);
+
+private:
+  void start(const std::string &method, const std::string &url,
+             const std::string &body, int timeoutMs, Callback callback);
+  void onEvents(uint32_t events);
+  void onWritable();
+  void onReadable();
+  void finish(Response response);
+  void fail(const std::string &error);
+
+  EventLoop *m_loop;
+  int m_fd = -1;
+  int m_timer = 0;
+  bool m_connected = false;
+  std::string m_out;
+  size_t m_outOffset = 0;
+  std::string m_in;
+  Callback m_callback;
+
+  static const char *const USER_AGENT;
+  static const size_t MAX_RESPONSE_SIZE;
+};
+
+#endif // HTTPCLIENT_H
@@ -0,0 +1,161 @@
+#include "eventloop.h"
+#include "guard.h"
+#include "uciconfig.h"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <syslog.h>
+#include <unistd.h>
+
+// HAUT Network Guard - OpenWrt 原生守护进程
+// 替代 main.lua: 单进程事件循环, 不再为日志/配置/HTTP/加密派生子进程
+namespace {
+
+const char *const DEFAULT_CONFIG = "/etc/config/haut-network-guard";
+
+void usage(const char *argv0) {
+  std::fprintf(stderr,
+               "用法: %s [-c 配置文件] [-f] [-n 周期数]\n"
+               "  -c  UCI 配置文件 (默认 %s)\n"
+               "  -f  日志同时输出到 stderr\n"
+               "  -n  完成指定次数的检测后退出 (用于测试与基准)\n",
+               argv0, DEFAULT_CONFIG);
+}
+
+bool loadSettings(const std::string &path, GuardSettings *settings) {
+  UciConfig config;
+  std::string error;
+  if (!config.load(path, &error)) {
+    syslog(LOG_ERR, "%s", error.c_str());
+    return false;
+  }
+  *settings = GuardSettings::fromUci(config);
+  return true;
+}
+
+// 退出时报告资源占用, 便于与 Lua 版本对比
+void logUsage(const Guard &guard, const EventLoop &loop) {
+  rusage usage;
+  ::getrusage(RUSAGE_SELF, &usage);
+  const double cpuMs = usage.ru_utime.tv_sec * 1000.0 +
+                       usage.ru_utime.tv_usec / 1000.0 +
+                       usage.ru_stime.tv_sec * 1000.0 +
+                       usage.ru_stime.tv_usec / 1000.0;
+  const Guard::Stats &stats = guard.stats();
+  syslog(LOG_INFO,
+         "退出: 检测 %llu 次, 登录 %llu 次, CPU %.2f ms/周期, "
+         "唤醒 %llu 次, 峰值 RSS %ld KB",
+         static_cast<unsigned long long>(stats.cycles),
+         static_cast<unsigned long long>(stats.logins),
+         stats.cycles ? cpuMs / stats.cycles : 0.0,
+         static_cast<unsigned long long>(loop.wakeups()), usage.ru_maxrss);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string configPath = DEFAULT_CONFIG;
+  bool foreground = false;
+  long maxCycles = 0;
+
+  int opt;
+  while ((opt = ::getopt(argc, argv, "c:fn:h")) != -1) {
+    switch (opt) {
+    case 'c':
+      configPath = optarg;
+      break;
+    case 'f':
+      foreground = true;
+      break;
+    case 'n':
+      maxCycles = std::strtol(optarg, nullptr, 10);
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 2;
+    }
+  }
+
+  ::openlog("haut-network-guard", LOG_PID | (foreground ? LOG_PERROR : 0),
+            LOG_DAEMON);
+  syslog(LOG_INFO, "HAUT Network Guard 启动 (原生)");
+
+  GuardSettings settings;
+  if (!loadSettings(configPath, &settings))
+    return 1;
+  if (!settings.enabled) {
+    syslog(LOG_WARNING, "服务已禁用");
+    return 0;
+  }
+  if (settings.username.empty() || settings.password.empty()) {
+    syslog(LOG_ERR, "未配置用户名或密码");
+    return 1;
+  }
+
+  EventLoop loop;
+  if (!loop.isValid()) {
+    syslog(LOG_ERR, "epoll 初始化失败");
+    return 1;
+  }
+
+  // 信号经 signalfd 进入事件循环: TERM/INT 退出, HUP 重新读取配置
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGTERM);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGHUP);
+  sigprocmask(SIG_BLOCK, &mask, nullptr);
+  const int sigFd = ::signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  if (sigFd < 0) {
+    syslog(LOG_ERR, "signalfd 初始化失败");
+    return 1;
+  }
+
+  Guard guard(&loop);
+  guard.setSettings(settings);
+
+  loop.watch(sigFd, EPOLLIN, [&](uint32_t) {
+    signalfd_siginfo info;
+    while (::read(sigFd, &info, sizeof(info)) == sizeof(info)) {
+      if (info.ssi_signo != SIGHUP) {
+        loop.quit();
+        return;
+      }
+      GuardSettings reloaded;
+      if (!loadSettings(configPath, &reloaded))
+        continue; // 保留旧配置
+      if (!reloaded.enabled) {
+        syslog(LOG_WARNING, "服务已禁用");
+        loop.quit();
+        return;
+      }
+      syslog(LOG_INFO, "配置已重新加载");
+      guard.setSettings(reloaded);
+      guard.start();
+    }
+  });
+
+  if (maxCycles > 0) {
+    guard.setCycleCallback([&]() {
+      if (guard.stats().cycles >= static_cast<uint64_t>(maxCycles))
+        loop.quit();
+    });
+  }
+
+  syslog(LOG_INFO, "用户: %s", settings.username.c_str());
+  syslog(LOG_INFO, "检测间隔: %d秒", settings.intervalSec);
+
+  guard.start();
+  const bool ok = loop.run();
+  guard.stop();
+  logUsage(guard, loop);
+
+  loop.unwatch(sigFd);
+  ::close(sigFd);
+  ::closelog();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+#include "uciconfig.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+// 按 UCI 语法切分一行: 空白分隔, 支持 '...' 与 "..." 及反斜杠转义
+bool tokenize(const std::string &line, std::vector<std::string> *tokens) {
+  size_t i = 0;
+  while (i < line.size()) {
+    while (i < line.size() && (line[i] == ' ' || line[i] == '\t'))
+      ++i;
+    if (i >= line.size() || line[i] == '#')
+      break;
+
+    std::string token;
+    while (i < line.size() && line[i] != ' ' && line[i] != '\t') {
+      const char c = line[i];
+      if (c == '\'' || c == '"') {
+        const size_t end = line.find(c, i + 1);
+        if (end == std::string::npos)
+          return false;
+        token.append(line, i + 1, end - i - 1);
+        i = end + 1;
+      } else if (c == '\\' && i + 1 < line.size()) {
+        token.push_back(line[i + 1]);
+        i += 2;
+      } else {
+        token.push_back(c);
+        ++i;
+      }
+    }
+    tokens->push_back(token);
+  }
+  return true;
+}
+
+} // namespace
+
+bool UciConfig::load(const std::string &path, std::string *error) {
+  FILE *file = std::fopen(path.c_str(), "r");
+  if (!file) {
+    *error = "无法打开配置文件: " + path;
+    return false;
+  }
+
+  m_sections.clear();
+  std::map<std::string, int> typeCounts;
+  Options *current = nullptr;
+  std::string line;
+  int lineNo = 0;
+  char buffer[512];
+  bool ok = true;
+
+  while (std::fgets(buffer, sizeof(buffer), file)) {
+    line.append(buffer);
+    if (!line.empty() && line.back() != '\n' && !std::feof(file))
+      continue; // 超长行, 继续读取
+    ++lineNo;
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+      line.pop_back();
+
+    std::vector<std::string> tokens;
+    if (!tokenize(line, &tokens)) {
+      *error = "第 " + std::to_string(lineNo) + " 行引号不匹配";
+      ok = false;
+      break;
+    }
+    line.clear();
+    if (tokens.empty())
+      continue;
+
+    if (tokens[0] == "config" && tokens.size() >= 2) {
+      // 匿名 section 同时可用 @type[index] 访问
+      const int index = typeCounts[tokens[1]]++;
+      std::string name = tokens.size() >= 3 ? tokens[2]
+                                            : "@" + tokens[1] + "[" +
+                                                  std::to_string(index) + "]";
+      current = &m_sections[name];
+    } else if (tokens[0] == "option" && tokens.size() >= 3 && current) {
+      (*current)[tokens[1]] = tokens[2];
+    }
+  }
+
+  std::fclose(file);
+  return ok;
+}
+
+std::string UciConfig::get(const std::string &section,
+                           const std::string &option,
+                           const std::string &defaultValue) const {
+  auto s = m_sections.find(section);
+  if (s == m_sections.end())
+    return defaultValue;
+  auto o = s->second.find(option);
+  return o == s->second.end() ? defaultValue : o->second;
+}
+
+int UciConfig::getInt(const std::string &section, const std::string &option,
+                      int defaultValue) const {
+  const std::string value = get(section, option);
+  if (value.empty())
+    return defaultValue;
+  char *end = nullptr;
+  long parsed = std::strtol(value.c_str(), &end, 10);
+  return *end == '\0' ? static_cast<int>(parsed) : defaultValue;
+}
+
+bool UciConfig::getBool(const std::string &section, const std::string &option,
+                        bool defaultValue) const {
+  const std::string value = get(section, option);
+  if (value.empty())
+    return defaultValue;
+  // 与 uci/procd 的布尔取值一致
+  return value == "1" || value == "on" || value == "true" || value == "yes" ||
+         value == "enabled";
+}
@@ -0,0 +1,26 @@
+#ifndef UCICONFIG_H
+#define UCICONFIG_H
+
+#include <map>
+#include <string>
+
+// 直接解析 UCI 配置文件 (/etc/config/*), 不依赖 libuci 与 uci 命令
+// 支持 config/option 语句及单双引号; list 语句被忽略
+class UciConfig {
+public:
+  bool load(const std::string &path, std::string *error);
+
+  // 按 section 名称 (匿名 section 为 @type[index]) 读取 option
+  std::string get(const std::string &section, const std::string &option,
+                  const std::string &defaultValue = std::string()) const;
+  int getInt(const std::string &section, const std::string &option,
+             int defaultValue) const;
+  bool getBool(const std::string &section, const std::string &option,
+               bool defaultValue) const;
+
+private:
+  typedef std::map<std::string, std::string> Options;
+  std::map<std::string, Options> m_sections;
+};
+
+#endif // UCICONFIG_H
@@ -15,6 +15,7 @@ echo "[1/3] 停止服务..."
 echo "[2/3] 删除程序文件..."
 rm -rf /usr/lib/haut-network-guard
 rm -f /etc/init.d/haut-network-guard
+rm -f /usr/sbin/haut-network-guard-lite
 
 # 删除配置
 echo "[3/3] 删除配置..."
@@ -14,6 +14,7 @@ echo "[1/3] 停止服务..."
 echo "[2/3] 删除文件..."
 rm -rf /usr/lib/haut-network-guard
 rm -f /etc/init.d/haut-network-guard
+rm -f /usr/sbin/haut-network-guard-lite
 
 # 删除配置 (可选)
 echo "[3/3] 删除配置..."
@@ -1,140 +1,223 @@
 #include "api.h"
-#include "encryption.h"
+#include "config.h"
+#include "metrics.h"
+#include "tracer.h"
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QNetworkProxy>
 #include <QNetworkReply>
 #include <QRegularExpression>
 #include <QUrl>
 #include <QUrlQuery>
 
-const QString Api::STATUS_URL = "http://172.16.154.130/cgi-bin/rad_user_info";
-const QString Api::LOGIN_URL = "http://172.16.154.130:69/cgi-bin/srun_portal";
-
 Api::Api(QObject *parent)
-    : QObject(parent), m_networkManager(new QNetworkAccessManager(this)) {}
+    : QObject(parent), m_networkManager(new QNetworkAccessManager(this)) {
+  setDirectRoute(Config::instance().directRoute());
+  setProfile(Config::instance().portalProfile());
+}
 
 Api::~Api() {}
 
+void Api::setDirectRoute(bool direct) {
+  // 显式 NoProxy 时 QNetworkAccessManager 不再查询代理工厂,
+  // 登录路径上没有任何 WPAD/PAC 计算; 关闭时回退到 (带缓存的) 系统代理
+  m_networkManager->setProxy(QNetworkProxy(
+      direct ? QNetworkProxy::NoProxy : QNetworkProxy::DefaultProxy));
+  Metrics::instance().set("portal_direct_route", direct ? 1 : 0);
+}
+
+void Api::setProfile(const QString &name) {
+  m_profile = PortalProfile::load(name);
+}
+
+void Api::setPortal(const QString &host, int statusPort) {
+  m_profile.setPortal(host, statusPort);
+}
+
+QUrl Api::portalUrl() const { return m_profile.loginUrl(); }
+
+bool Api::admit(Operation operation) {
+  PortalThrottle &throttle = PortalThrottle::instance();
+  switch (throttle.acquire()) {
+  case PortalThrottle::Admission::Allowed:
+  case PortalThrottle::Admission::Probe:
+    return true;
+  case PortalThrottle::Admission::RateLimited:
+    Tracer::instant("api", "rate_limited");
+    emit requestRejected(operation, "请求过于频繁, 已限流");
+    return false;
+  case PortalThrottle::Admission::CircuitOpen:
+    Tracer::instant("api", "circuit_open", "retry_after_ms",
+                    throttle.retryAfterMs());
+    emit requestRejected(operation,
+                         QString("认证服务器异常, %1 秒后重试")
+                             .arg((throttle.retryAfterMs() + 999) / 1000));
+    return false;
+  }
+  return false;
+}
+
+PortalThrottle::Outcome Api::classifyError(QNetworkReply *reply) {
+  int httpStatus =
+      reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  if (httpStatus >= 500)
+    return PortalThrottle::Outcome::Failure;
+
+  switch (reply->error()) {
+  case QNetworkReply::NoError:
+    return PortalThrottle::Outcome::Success;
+  // setTransferTimeout 超时表现为 OperationCanceledError
+  case QNetworkReply::TimeoutError:
+  case QNetworkReply::OperationCanceledError:
+    return PortalThrottle::Outcome::Failure;
+  default:
+    // 本机断网/无路由等, 不代表服务器状态
+    return PortalThrottle::Outcome::Neutral;
+  }
+}
+
 void Api::login(const QString &username, const QString &password) {
-  // 加密用户名和密码
-  QString encUsername = Encryption::encryptUsername(username);
-  QString encPassword = Encryption::encryptPassword(password);
-
-  // 构建 POST 请求体 (与 Rust 版本一致)
-  QUrlQuery postData;
-  postData.addQueryItem("action", "login");
-  postData.addQueryItem("username", encUsername);
-  postData.addQueryItem("password", encPassword);
-  postData.addQueryItem("ac_id", "1");
-  postData.addQueryItem("drop", "0");
-  postData.addQueryItem("pop", "1");
-  postData.addQueryItem("type", "10");
-  postData.addQueryItem("n", "117");
-  postData.addQueryItem("mbytes", "0");
-  postData.addQueryItem("minutes", "0");
-  postData.addQueryItem("mac", "02:00:00:00:00:00");
-
-  QUrl loginUrl(LOGIN_URL);
-  QNetworkRequest request(loginUrl);
-  request.setHeader(QNetworkRequest::ContentTypeHeader,
-                    "application/x-www-form-urlencoded");
-  request.setHeader(QNetworkRequest::UserAgentHeader,
-                    "HAUTNetworkGuard/1.3.5 Qt");
-  request.setTransferTimeout(10000);
+  if (!m_profile.isValid()) {
+    emit loginFailed("门户配置无效", PortalError::Code::Unknown,
+                     PortalError::Policy::Stop);
+    return;
+  }
+  if (!admit(Operation::Login))
+    return;
+  m_lastUsername = username;
+
+  // 按门户配置加密用户名和密码, 填入预编译的请求模板
+  const PortalProfile::RequestTemplate &tpl = m_profile.loginTemplate();
+  QByteArray body = tpl.build(m_profile.encodeUsername(username),
+                              m_profile.encodePassword(password));
 
-  QNetworkReply *reply = m_networkManager->post(
-      request, postData.toString(QUrl::FullyEncoded).toUtf8());
+  QNetworkReply *reply = m_networkManager->post(tpl.request, body);
+  Tracer::traceReply(reply, "login");
   connect(reply, &QNetworkReply::finished, this, &Api::onLoginReplyFinished);
 }
 
 void Api::logout() {
-  QUrlQuery postData;
-  postData.addQueryItem("action", "logout");
-
-  QUrl logoutUrl(LOGIN_URL);
-  QNetworkRequest request(logoutUrl);
-  request.setHeader(QNetworkRequest::ContentTypeHeader,
-                    "application/x-www-form-urlencoded");
-  request.setHeader(QNetworkRequest::UserAgentHeader,
-                    "HAUTNetworkGuard/1.3.5 Qt");
-  request.setTransferTimeout(10000);
+  if (!m_profile.isValid()) {
+    emit logoutFailed("门户配置无效");
+    return;
+  }
+  if (!admit(Operation::Logout))
+    return;
 
-  QNetworkReply *reply = m_networkManager->post(
-      request, postData.toString(QUrl::FullyEncoded).toUtf8());
+  const PortalProfile::RequestTemplate &tpl = m_profile.logoutTemplate();
+  QNetworkReply *reply = m_networkManager->post(tpl.request, tpl.build());
+  Tracer::traceReply(reply, "logout");
   connect(reply, &QNetworkReply::finished, this, &Api::onLogoutReplyFinished);
 }
 
 void Api::checkStatus() {
+  if (!m_profile.isValid()) {
+    emit statusChecked(false, "", 0, 0);
+    return;
+  }
+  if (!admit(Operation::Status))
+    return;
+
   // 使用 JSONP callback 格式获取 JSON 响应 (与 OpenWrt 一致)
   qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
   QString callback = QString("jQuery_%1").arg(timestamp);
 
-  QUrl url(STATUS_URL);
+  QUrl url = m_profile.statusUrl();
   QUrlQuery query;
   query.addQueryItem("callback", callback);
   query.addQueryItem("_", QString::number(timestamp));
   url.setQuery(query);
 
+  QNetworkRequest request = m_profile.statusRequest();
+  request.setUrl(url);
+
+  QNetworkReply *reply = m_networkManager->get(request);
+  Tracer::traceReply(reply, "status");
+  connect(reply, &QNetworkReply::finished, this, &Api::onStatusReplyFinished);
+}
+
+void Api::keepAlive() {
+  QUrl url = m_profile.keepAliveUrl();
+  if (!url.isValid() || url.isEmpty())
+    return;
+
   QNetworkRequest request(url);
   request.setHeader(QNetworkRequest::UserAgentHeader,
-                    "HAUTNetworkGuard/1.3.5 Qt");
+                    PortalProfile::USER_AGENT);
   request.setTransferTimeout(5000);
-
   QNetworkReply *reply = m_networkManager->get(request);
-  connect(reply, &QNetworkReply::finished, this, &Api::onStatusReplyFinished);
+  Tracer::traceReply(reply, "keepalive");
+  connect(reply, &QNetworkReply::finished, reply, &QObject::deleteLater);
+  Metrics::instance().add("portal_keepalive_count");
 }
 
 void Api::onLoginReplyFinished() {
   QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
   if (!reply)
     return;
+  TraceScope trace("api", "parse_login");
 
   reply->deleteLater();
 
+  PortalThrottle &throttle = PortalThrottle::instance();
   if (reply->error() != QNetworkReply::NoError) {
-    emit loginFailed(QString("网络错误: %1").arg(reply->errorString()));
+    throttle.record(classifyError(reply));
+    emit loginFailed(QString("网络错误: %1").arg(reply->errorString()),
+                     PortalError::network().code,
+                     PortalError::network().policy);
     return;
   }
 
-  QString response = QString::fromUtf8(reply->readAll());
+  QByteArray data = reply->readAll();
 
-  // 检查登录结果 (与 Rust 版本一致)
-  if (response.contains("login_ok") || response.contains("already_online")) {
+  // 检查登录结果 (匹配模式来自门户配置)
+  if (m_profile.loginSuccess().matches(data)) {
+    throttle.record(PortalThrottle::Outcome::Success);
     emit loginSuccess("登录成功");
+    return;
+  }
+
+  // 查错误码表, 只有服务器自身故障计入熔断; 未识别的响应既不计为故障,
+  // 也不能证明服务器正常
+  const PortalError::Info &info = PortalError::fromResponse(data);
+  if (PortalError::isServerFault(info))
+    throttle.record(PortalThrottle::Outcome::Failure);
+  else if (info.code != PortalError::Code::Unknown)
+    throttle.record(PortalThrottle::Outcome::Success);
+  else
+    throttle.record(PortalThrottle::Outcome::Neutral);
+
+  QString error;
+  if (info.code != PortalError::Code::Unknown) {
+    error = QString("登录失败: %1 (%2)")
+                .arg(QString::fromUtf8(info.message),
+                     QString::fromLatin1(info.key));
   } else {
-    // 提取错误信息
-    QString error = "登录失败";
-    if (response.contains("E")) {
-      // 尝试提取错误码
-      QRegularExpression errRe("E(\\d+)");
-      QRegularExpressionMatch match = errRe.match(response);
-      if (match.hasMatch()) {
-        error = QString("登录失败 (错误码: E%1)").arg(match.captured(1));
-      }
-    }
-    if (!response.isEmpty() && response.length() < 200) {
-      error = response;
-    }
-    emit loginFailed(error);
+    // 未收录的错误保留简短的原始响应便于排查
+    QString response = QString::fromUtf8(data).trimmed();
+    error = response.isEmpty() || response.length() >= 200
+                ? QString("登录失败")
+                : QString("登录失败: %1").arg(response);
   }
+  emit loginFailed(error, info.code, info.policy);
 }
 
 void Api::onLogoutReplyFinished() {
   QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
   if (!reply)
     return;
+  TraceScope trace("api", "parse_logout");
 
   reply->deleteLater();
 
+  PortalThrottle::instance().record(classifyError(reply));
   if (reply->error() != QNetworkReply::NoError) {
     emit logoutFailed(QString("网络错误: %1").arg(reply->errorString()));
     return;
   }
 
-  QString response = QString::fromUtf8(reply->readAll());
-
-  // 与 Rust 版本一致
-  if (response.contains("logout_ok") || response.contains("not_online")) {
+  // 匹配模式来自门户配置
+  if (m_profile.logoutSuccess().matches(reply->readAll())) {
     emit logoutSuccess();
   } else {
     emit logoutFailed("注销失败");
@@ -145,26 +228,33 @@ void Api::onStatusReplyFinished() {
   QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
   if (!reply)
     return;
+  TraceScope trace("api", "parse_status");
 
   reply->deleteLater();
 
+  PortalThrottle::instance().record(classifyError(reply));
   if (reply->error() != QNetworkReply::NoError) {
+    // 有 HTTP 状态码说明服务器可达, 只是返回了错误
+    emit portalReachability(
+        reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid());
     emit statusChecked(false, "", 0, 0);
     return;
   }
+  emit portalReachability(true);
 
-  QString response = QString::fromUtf8(reply->readAll());
+  QByteArray data = reply->readAll();
 
-  // 如果响应为空或包含 "not_online"，则离线
-  if (response.isEmpty() || response.contains("not_online")) {
+  // 如果响应为空或命中离线标记，则离线
+  if (data.isEmpty() || m_profile.statusOffline().matches(data)) {
     emit statusChecked(false, "", 0, 0);
     return;
   }
 
   // 尝试解析 JSONP 响应 (与 OpenWrt 一致)
   // 格式: callback({...})
+  QString response = QString::fromUtf8(data);
   QString jsonStr;
-  QRegularExpression jsonpRe("jQuery_\\d+\\((.+)\\)$");
+  static const QRegularExpression jsonpRe("jQuery_\\d+\\((.+)\\)$");
   QRegularExpressionMatch match = jsonpRe.match(response.trimmed());
   if (match.hasMatch()) {
     jsonStr = match.captured(1);
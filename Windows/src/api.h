@@ -5,11 +5,19 @@
 #include <QNetworkReply>
 #include <QObject>
 #include <QString>
+#include <QUrl>
+
+#include "portalerror.h"
+#include "portalprofile.h"
+#include "portalthrottle.h"
 
 class Api : public QObject {
   Q_OBJECT
 
 public:
+  enum class Operation { Login, Logout, Status };
+  Q_ENUM(Operation)
+
   explicit Api(QObject *parent = nullptr);
   ~Api();
 
@@ -22,13 +30,38 @@ public:
   // 检测在线状态
   void checkStatus();
 
+  // 保活: 访问外网地址产生少量流量, 不经过限流且不发出信号
+  void keepAlive();
+
+  // 直连模式: 认证请求不经过系统代理
+  void setDirectRoute(bool direct);
+
+  // 切换门户配置 (空名称使用默认配置)
+  void setProfile(const QString &name);
+  const PortalProfile &profile() const { return m_profile; }
+
+  // 切换到自动发现的认证服务器 (重新加载配置后失效)
+  void setPortal(const QString &host, int statusPort);
+
+  // 认证服务器地址 (用于启动就绪探测)
+  QUrl portalUrl() const;
+
+  // 最近一次登录请求使用的账号
+  QString lastUsername() const { return m_lastUsername; }
+
 signals:
   void loginSuccess(const QString &message);
-  void loginFailed(const QString &error);
+  // code/policy 来自错误码表, 决定是否以及何时重试
+  void loginFailed(const QString &error, PortalError::Code code,
+                   PortalError::Policy policy);
   void logoutSuccess();
   void logoutFailed(const QString &error);
   void statusChecked(bool online, const QString &ip, qint64 bytesUsed,
                      qint64 secondsOnline);
+  // 请求被限流/熔断拦截, 未发往认证服务器
+  void requestRejected(Api::Operation operation, const QString &reason);
+  // 每次状态查询后发出: 是否收到认证服务器的 HTTP 响应
+  void portalReachability(bool reachable);
 
 private slots:
   void onLoginReplyFinished();
@@ -36,10 +69,14 @@ private slots:
   void onStatusReplyFinished();
 
 private:
-  QNetworkAccessManager *m_networkManager;
+  // 申请限流/熔断许可, 被拦截时发出 requestRejected
+  bool admit(Operation operation);
+  // 根据网络错误判断结果是否反映服务器故障
+  static PortalThrottle::Outcome classifyError(QNetworkReply *reply);
 
-  static const QString STATUS_URL;
-  static const QString LOGIN_URL;
+  QNetworkAccessManager *m_networkManager;
+  PortalProfile m_profile;
+  QString m_lastUsername;
 };
 
 #endif // API_H
@@ -0,0 +1,182 @@
+#include "bootsequence.h"
+#include <QDebug>
+#include <QHostAddress>
+#include <QNetworkInformation>
+#include <QNetworkInterface>
+
+const int BootSequence::POLL_INTERVAL_MS = 200;
+const int BootSequence::PROBE_TIMEOUT_MS = 1500;
+
+BootSequence::BootSequence(const QUrl &portalUrl, QObject *parent)
+    : QObject(parent), m_host(portalUrl.host()),
+      m_port(static_cast<quint16>(portalUrl.port(80))),
+      m_pollTimer(new QTimer(this)), m_deadlineTimer(new QTimer(this)),
+      m_probeTimer(new QTimer(this)) {
+  m_pollTimer->setInterval(POLL_INTERVAL_MS);
+  connect(m_pollTimer, &QTimer::timeout, this, &BootSequence::poll);
+
+  m_deadlineTimer->setSingleShot(true);
+  connect(m_deadlineTimer, &QTimer::timeout, this, &BootSequence::onDeadline);
+
+  m_probeTimer->setSingleShot(true);
+  m_probeTimer->setInterval(PROBE_TIMEOUT_MS);
+  connect(m_probeTimer, &QTimer::timeout, this, &BootSequence::onProbeFailed);
+
+  // 系统网络状态变化时立即重新检测, 不必等下一次轮询
+  if (QNetworkInformation::loadDefaultBackend()) {
+    connect(QNetworkInformation::instance(),
+            &QNetworkInformation::reachabilityChanged, this,
+            &BootSequence::poll);
+  }
+}
+
+BootSequence::~BootSequence() { abortProbe(); }
+
+void BootSequence::start(int deadlineMs) {
+  m_clock.start();
+  setStage(Stage::WaitInterface);
+  m_deadlineTimer->start(deadlineMs);
+  m_pollTimer->start();
+  poll();
+}
+
+void BootSequence::stop() {
+  m_pollTimer->stop();
+  m_deadlineTimer->stop();
+  abortProbe();
+}
+
+qint64 BootSequence::elapsedMs() const {
+  return m_clock.isValid() ? m_clock.elapsed() : 0;
+}
+
+void BootSequence::poll() {
+  switch (m_stage) {
+  case Stage::WaitInterface:
+    if (!hasInterfaceAddress())
+      return;
+    setStage(Stage::WaitRoute);
+    Q_FALLTHROUGH();
+  case Stage::WaitRoute:
+    if (!QHostAddress(m_host).isNull()) {
+      // 路由检测异步完成, 结果到达后进入下一阶段
+      if (!m_routeProbe)
+        probeRoute();
+      return;
+    }
+    // 主机名需要 DNS, 交给 TCP 探测判断
+    setStage(Stage::WaitPortal);
+    Q_FALLTHROUGH();
+  case Stage::WaitPortal:
+    // 同一时刻只保留一个探测连接
+    if (!m_probe)
+      probePortal();
+    break;
+  default:
+    break;
+  }
+}
+
+bool BootSequence::hasInterfaceAddress() const {
+  const auto interfaces = QNetworkInterface::allInterfaces();
+  for (const QNetworkInterface &iface : interfaces) {
+    const auto flags = iface.flags();
+    if (!(flags & QNetworkInterface::IsUp) ||
+        !(flags & QNetworkInterface::IsRunning) ||
+        (flags & QNetworkInterface::IsLoopBack))
+      continue;
+
+    const auto entries = iface.addressEntries();
+    for (const QNetworkAddressEntry &entry : entries) {
+      const QHostAddress ip = entry.ip();
+      // 169.254.x.x 为 DHCP 失败时的自动地址, 不算就绪
+      if (ip.protocol() == QAbstractSocket::IPv4Protocol &&
+          !ip.isLinkLocal())
+        return true;
+    }
+  }
+  return false;
+}
+
+void BootSequence::probeRoute() {
+  // UDP connect 不发包, 只让系统按路由表选择源地址; 无路由时报错.
+  // 结果经信号返回, 不阻塞事件循环
+  m_routeProbe = new QUdpSocket(this);
+  connect(m_routeProbe, &QUdpSocket::connected, this,
+          &BootSequence::onRouteProbeConnected);
+  connect(m_routeProbe, &QUdpSocket::errorOccurred, this,
+          &BootSequence::onProbeFailed);
+  m_probeTimer->start();
+  m_routeProbe->connectToHost(QHostAddress(m_host), m_port);
+}
+
+void BootSequence::probePortal() {
+  m_probe = new QTcpSocket(this);
+  connect(m_probe, &QTcpSocket::connected, this,
+          &BootSequence::onProbeConnected);
+  connect(m_probe, &QTcpSocket::errorOccurred, this,
+          &BootSequence::onProbeFailed);
+  m_probeTimer->start();
+  m_probe->connectToHost(m_host, m_port);
+}
+
+void BootSequence::abortProbe() {
+  m_probeTimer->stop();
+  if (m_routeProbe) {
+    m_routeProbe->disconnect(this);
+    m_routeProbe->abort();
+    m_routeProbe->deleteLater();
+    m_routeProbe = nullptr;
+  }
+  if (m_probe) {
+    m_probe->disconnect(this);
+    m_probe->abort();
+    m_probe->deleteLater();
+    m_probe = nullptr;
+  }
+}
+
+void BootSequence::onRouteProbeConnected() {
+  const bool routed = !m_routeProbe->localAddress().isNull();
+  abortProbe();
+  if (!routed || m_stage != Stage::WaitRoute)
+    return;
+  setStage(Stage::WaitPortal);
+  probePortal();
+}
+
+void BootSequence::onProbeConnected() {
+  abortProbe();
+  finish(Stage::Ready);
+}
+
+void BootSequence::onProbeFailed() {
+  // 无路由、连接被拒或超时, 下一次轮询重新探测
+  abortProbe();
+}
+
+void BootSequence::onDeadline() { finish(Stage::TimedOut); }
+
+void BootSequence::setStage(Stage stage) {
+  if (m_stage == stage)
+    return;
+  m_stage = stage;
+  emit stageChanged(stage);
+}
+
+void BootSequence::finish(Stage stage) {
+  if (m_stage == Stage::Ready || m_stage == Stage::TimedOut)
+    return;
+
+  stop();
+  setStage(stage);
+
+  qint64 elapsed = elapsedMs();
+  if (stage == Stage::Ready) {
+    qInfo() << "启动就绪, 用时" << elapsed << "ms";
+    emit ready(elapsed);
+  } else {
+    qWarning() << "启动就绪检测超时, 用时" << elapsed << "ms";
+    emit timedOut(elapsed);
+  }
+}
@@ -0,0 +1,72 @@
+#ifndef BOOTSEQUENCE_H
+#define BOOTSEQUENCE_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QUrl>
+
+// 启动就绪状态机: 网卡有地址 -> 有到认证服务器的路由 -> 认证端口可连接
+// 条件满足立即发出 ready(), 超过总时限发出 timedOut()
+class BootSequence : public QObject {
+  Q_OBJECT
+
+public:
+  enum class Stage {
+    Idle,
+    WaitInterface, // 等待网卡获得 IPv4 地址
+    WaitRoute,     // 等待到认证服务器的路由
+    WaitPortal,    // 等待认证端口接受 TCP 连接
+    Ready,
+    TimedOut
+  };
+  Q_ENUM(Stage)
+
+  explicit BootSequence(const QUrl &portalUrl, QObject *parent = nullptr);
+  ~BootSequence();
+
+  // 开始检测, deadlineMs 为总时限
+  void start(int deadlineMs = 45000);
+  void stop();
+
+  Stage stage() const { return m_stage; }
+  qint64 elapsedMs() const;
+
+signals:
+  void stageChanged(BootSequence::Stage stage);
+  void ready(qint64 elapsedMs);
+  void timedOut(qint64 elapsedMs);
+
+private slots:
+  void poll();
+  void onDeadline();
+  void onRouteProbeConnected();
+  void onProbeConnected();
+  void onProbeFailed();
+
+private:
+  bool hasInterfaceAddress() const;
+  void probeRoute();
+  void probePortal();
+  void abortProbe();
+  void setStage(Stage stage);
+  void finish(Stage stage);
+
+  QString m_host;
+  quint16 m_port;
+
+  Stage m_stage = Stage::Idle;
+  QTimer *m_pollTimer;
+  QTimer *m_deadlineTimer;
+  QTimer *m_probeTimer;
+  QUdpSocket *m_routeProbe = nullptr;
+  QTcpSocket *m_probe = nullptr;
+  QElapsedTimer m_clock;
+
+  static const int POLL_INTERVAL_MS;
+  static const int PROBE_TIMEOUT_MS;
+};
+
+#endif // BOOTSEQUENCE_H
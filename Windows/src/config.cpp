@@ -1,11 +1,19 @@
 #include "config.h"
 #include <QCoreApplication>
 #include <QDir>
+#include <QScopedPointer>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
 #endif
 
+namespace {
+// 发布页附带的增量更新清单
+const char *const DEFAULT_UPDATE_URL =
+    "https://github.com/yellowpeachxgp/HAUTNetworkGuard/releases/latest/"
+    "download/manifest.json";
+} // namespace
+
 Config &Config::instance() {
   static Config instance;
   return instance;
@@ -13,33 +21,54 @@ Config &Config::instance() {
 
 Config::Config() { load(); }
 
-void Config::load() {
-  QSettings settings("HAUTNetworkGuard", "HAUTNetworkGuard");
+QSettings *Config::openSettings() const {
+  if (!m_filePath.isEmpty())
+    return new QSettings(m_filePath, QSettings::IniFormat);
+  return new QSettings("HAUTNetworkGuard", "HAUTNetworkGuard");
+}
 
-  m_username = settings.value("username", "").toString();
-  m_password = decodePassword(settings.value("password", "").toString());
-  m_autoSave = settings.value("auto_save", false).toBool();
-  m_autoLaunch = settings.value("auto_launch", false).toBool();
-  m_hasConfigured = settings.value("has_configured", false).toBool();
-  m_checkInterval = settings.value("check_interval", 30).toInt();
-  m_autoLogin = settings.value("auto_login", true).toBool();
+void Config::load() {
+  QScopedPointer<QSettings> settings(openSettings());
+
+  m_username = settings->value("username", "").toString();
+  m_password = decodePassword(settings->value("password", "").toString());
+  // 手写的配置文件 (如守护进程) 可直接填写明文密码
+  if (settings->contains("password_plain"))
+    m_password = settings->value("password_plain").toString();
+  m_autoSave = settings->value("auto_save", false).toBool();
+  m_autoLaunch = settings->value("auto_launch", false).toBool();
+  m_hasConfigured = settings->value("has_configured", false).toBool();
+  m_checkInterval = settings->value("check_interval", 30).toInt();
+  m_autoLogin = settings->value("auto_login", true).toBool();
+  m_directRoute = settings->value("direct_route", true).toBool();
+  m_portalProfile = settings->value("portal_profile", "").toString();
+  m_qualityMonitor = settings->value("quality_monitor", false).toBool();
+  m_qualityTargets = settings->value("quality_targets").toStringList();
+  m_updateCheck = settings->value("update_check", true).toBool();
+  m_updateUrl =
+      settings->value("update_url", DEFAULT_UPDATE_URL).toString();
 
   // 确保间隔在合理范围内
   m_checkInterval = qBound(5, m_checkInterval, 300);
 }
 
 void Config::save() {
-  QSettings settings("HAUTNetworkGuard", "HAUTNetworkGuard");
-
-  settings.setValue("username", m_username);
-  settings.setValue("password", encodePassword(m_password));
-  settings.setValue("auto_save", m_autoSave);
-  settings.setValue("auto_launch", m_autoLaunch);
-  settings.setValue("has_configured", m_hasConfigured);
-  settings.setValue("check_interval", m_checkInterval);
-  settings.setValue("auto_login", m_autoLogin);
-
-  settings.sync();
+  QScopedPointer<QSettings> settings(openSettings());
+
+  settings->setValue("username", m_username);
+  settings->setValue("password", encodePassword(m_password));
+  settings->setValue("auto_save", m_autoSave);
+  settings->setValue("auto_launch", m_autoLaunch);
+  settings->setValue("has_configured", m_hasConfigured);
+  settings->setValue("check_interval", m_checkInterval);
+  settings->setValue("auto_login", m_autoLogin);
+  settings->setValue("direct_route", m_directRoute);
+  settings->setValue("portal_profile", m_portalProfile);
+  settings->setValue("quality_monitor", m_qualityMonitor);
+  settings->setValue("quality_targets", m_qualityTargets);
+  settings->setValue("update_check", m_updateCheck);
+
+  settings->sync();
 }
 
 QString Config::encodePassword(const QString &password) {
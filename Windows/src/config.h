@@ -3,6 +3,7 @@
 
 #include <QSettings>
 #include <QString>
+#include <QStringList>
 
 class Config {
 public:
@@ -12,6 +13,10 @@ public:
   void load();
   void save();
 
+  // 指定 INI 配置文件 (守护进程使用), 为空时使用系统默认位置
+  void setFilePath(const QString &path) { m_filePath = path; }
+  QString filePath() const { return m_filePath; }
+
   // 配置项
   QString username() const { return m_username; }
   void setUsername(const QString &username) { m_username = username; }
@@ -38,10 +43,33 @@ public:
   bool autoLogin() const { return m_autoLogin; }
   void setAutoLogin(bool autoLogin) { m_autoLogin = autoLogin; }
 
+  // 认证流量直连 (跳过系统代理)
+  bool directRoute() const { return m_directRoute; }
+  void setDirectRoute(bool directRoute) { m_directRoute = directRoute; }
+
+  // 门户配置名称 (空为默认配置)
+  QString portalProfile() const { return m_portalProfile; }
+  void setPortalProfile(const QString &name) { m_portalProfile = name; }
+
+  // 网络质量监测 (TCP 连接探测), 附加目标格式 host[:port]
+  bool qualityMonitor() const { return m_qualityMonitor; }
+  void setQualityMonitor(bool enabled) { m_qualityMonitor = enabled; }
+  QStringList qualityTargets() const { return m_qualityTargets; }
+  void setQualityTargets(const QStringList &targets) {
+    m_qualityTargets = targets;
+  }
+
+  // 增量更新: 上线后自动检查一次, 清单地址可指向本地服务器
+  bool updateCheck() const { return m_updateCheck; }
+  void setUpdateCheck(bool enabled) { m_updateCheck = enabled; }
+  QString updateUrl() const { return m_updateUrl; }
+
 private:
   Config();
   ~Config() = default;
 
+  QSettings *openSettings() const;
+
   // 简单的密码混淆
   QString encodePassword(const QString &password);
   QString decodePassword(const QString &encoded);
@@ -49,13 +77,20 @@ private:
   // 设置开机自启动
   void updateAutoLaunchRegistry(bool enable);
 
+  QString m_filePath;
   QString m_username;
   QString m_password;
+  QString m_portalProfile;
+  QStringList m_qualityTargets;
+  QString m_updateUrl;
   bool m_autoSave = false;
   bool m_autoLaunch = false;
   bool m_hasConfigured = false;
   int m_checkInterval = 30; // 默认 30 秒
   bool m_autoLogin = true;  // 默认开启自动登录
+  bool m_directRoute = true; // 默认认证流量直连
+  bool m_qualityMonitor = false;
+  bool m_updateCheck = true;
 };
 
 #endif // CONFIG_H
@@ -0,0 +1,98 @@
+#include "ipcclient.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+// 命令行前端: 通过本地控制通道查询状态或请求登录/注销,
+// 不直接访问认证服务器
+namespace {
+
+QTextStream &out() {
+  static QTextStream stream(stdout);
+  return stream;
+}
+
+void printStatus(const IpcProtocol::StatusSnapshot &snapshot) {
+  if (!snapshot.valid) {
+    out() << "unknown (尚未完成状态检测)" << Qt::endl;
+    return;
+  }
+  QString time =
+      QDateTime::fromMSecsSinceEpoch(snapshot.timestamp).toString("HH:mm:ss");
+  if (snapshot.online) {
+    out() << "online ip=" << snapshot.ip << " bytes=" << snapshot.bytesUsed
+          << " seconds=" << snapshot.secondsOnline << " checked=" << time
+          << Qt::endl;
+  } else {
+    out() << "offline checked=" << time << Qt::endl;
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  app.setApplicationName("haut-network-guard-ctl");
+  app.setApplicationVersion("1.3.5");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("HAUT Network Guard 本地控制工具");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  parser.addPositionalArgument("command", "status | watch | login | logout");
+  QCommandLineOption nameOption("socket", "控制通道名称", "name",
+                                IpcProtocol::serverName());
+  parser.addOption(nameOption);
+  parser.process(app);
+
+  const QStringList args = parser.positionalArguments();
+  const QString command = args.isEmpty() ? "status" : args.first();
+
+  IpcClient client;
+  if (!client.connectToGuard(parser.value(nameOption))) {
+    QTextStream(stderr) << "无法连接到 HAUT Network Guard" << Qt::endl;
+    return 2;
+  }
+
+  QElapsedTimer timer;
+  QObject::connect(&client, &IpcClient::disconnected, &app,
+                   [] { QCoreApplication::exit(2); });
+  QObject::connect(&client, &IpcClient::errorReceived, &app,
+                   [](const QString &message) {
+                     QTextStream(stderr) << message << Qt::endl;
+                     QCoreApplication::exit(1);
+                   });
+
+  if (command == "status") {
+    QObject::connect(&client, &IpcClient::statusReceived, &app,
+                     [&timer](const IpcProtocol::StatusSnapshot &snapshot) {
+                       printStatus(snapshot);
+                       out() << "latency_us=" << timer.nsecsElapsed() / 1000
+                             << Qt::endl;
+                       QCoreApplication::exit(snapshot.online ? 0 : 1);
+                     });
+    timer.start();
+    client.requestStatus();
+  } else if (command == "watch") {
+    QObject::connect(&client, &IpcClient::statusReceived, &app, &printStatus);
+    client.subscribe();
+  } else if (command == "login" || command == "logout") {
+    auto onResult = [](bool ok, const QString &message) {
+      out() << message << Qt::endl;
+      QCoreApplication::exit(ok ? 0 : 1);
+    };
+    if (command == "login") {
+      QObject::connect(&client, &IpcClient::loginResult, &app, onResult);
+      client.login();
+    } else {
+      QObject::connect(&client, &IpcClient::logoutResult, &app, onResult);
+      client.logout();
+    }
+  } else {
+    parser.showHelp(1);
+  }
+
+  return app.exec();
+}
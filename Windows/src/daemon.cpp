@@ -0,0 +1,279 @@
+#include "daemon.h"
+#include "config.h"
+#include "metrics.h"
+#include "sdnotify.h"
+#include <QCoreApplication>
+#include <QDebug>
+
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+
+int GuardDaemon::s_signalFd[2] = {-1, -1};
+const int GuardDaemon::LOGOUT_TIMEOUT_MS = 3000;
+
+GuardDaemon::GuardDaemon(QObject *parent)
+    : QObject(parent), m_api(new Api(this)), m_clock(new SystemClock(this)),
+      m_watchdogTimer(new QTimer(this)), m_shutdownTimer(new QTimer(this)) {
+  m_startClock.start();
+
+  connect(m_api, &Api::statusChecked, this, &GuardDaemon::onStatusChecked);
+  connect(m_api, &Api::loginSuccess, this, &GuardDaemon::onLoginSuccess);
+  connect(m_api, &Api::loginFailed, this, &GuardDaemon::onLoginFailed);
+  connect(m_api, &Api::requestRejected, this,
+          &GuardDaemon::onRequestRejected);
+
+  m_portalDiscovery = new PortalDiscovery(m_api, this);
+  m_stateSnapshot = new StateSnapshot(m_api, this);
+  if (m_stateSnapshot->load())
+    m_stateSnapshot->restorePortal();
+
+  // 断线重连由与界面共用的状态机负责
+  m_controller =
+      new GuardController(m_clock, new ApiTransport(m_api, this), this);
+  applyControllerSettings();
+  m_stateSnapshot->setController(m_controller);
+  m_ipcServer = new IpcServer(m_api, m_controller, this);
+
+  // 主动刷新会话时等待本机低流量时刻
+  m_throughputSampler = new ThroughputSampler(this);
+  m_controller->setQuietCheck(
+      [this]() { return m_throughputSampler->isQuiet(); });
+  connect(m_portalDiscovery, &PortalDiscovery::discovered, m_controller,
+          &GuardController::checkNow);
+
+  m_powerMonitor = new PowerMonitor(this);
+  m_controller->setLowPowerCheck(
+      [this]() { return m_powerMonitor->lowPower(); });
+  connect(m_powerMonitor, &PowerMonitor::resumed, m_controller,
+          &GuardController::wake);
+  connect(m_powerMonitor, &PowerMonitor::networkUp, m_controller,
+          &GuardController::wake);
+
+  m_bootSequence = new BootSequence(m_api->portalUrl(), this);
+  connect(m_bootSequence, &BootSequence::ready, this,
+          &GuardDaemon::onBootFinished);
+  connect(m_bootSequence, &BootSequence::timedOut, this,
+          &GuardDaemon::onBootTimedOut);
+
+  connect(m_watchdogTimer, &QTimer::timeout, this, &GuardDaemon::onWatchdog);
+
+  m_shutdownTimer->setSingleShot(true);
+  connect(m_shutdownTimer, &QTimer::timeout, this,
+          &GuardDaemon::finishShutdown);
+
+  if (s_signalFd[1] >= 0) {
+    m_signalNotifier =
+        new QSocketNotifier(s_signalFd[1], QSocketNotifier::Read, this);
+    connect(m_signalNotifier, &QSocketNotifier::activated, this,
+            &GuardDaemon::onSignal);
+  }
+}
+
+GuardDaemon::~GuardDaemon() {}
+
+bool GuardDaemon::installSignalHandlers() {
+  // 信号处理函数中只写 socketpair, 实际处理回到事件循环中进行
+  if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, s_signalFd) != 0)
+    return false;
+
+  struct sigaction action = {};
+  action.sa_handler = GuardDaemon::signalHandler;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+
+  return ::sigaction(SIGHUP, &action, nullptr) == 0 &&
+         ::sigaction(SIGTERM, &action, nullptr) == 0 &&
+         ::sigaction(SIGINT, &action, nullptr) == 0;
+}
+
+void GuardDaemon::signalHandler(int signo) {
+  char c = static_cast<char>(signo);
+  ssize_t ignored = ::write(s_signalFd[0], &c, 1);
+  Q_UNUSED(ignored);
+}
+
+bool GuardDaemon::start(const QString &socketName) {
+  const Config &config = Config::instance();
+  qInfo() << "HAUT Network Guard 守护进程启动, 用户:" << config.username()
+          << "检测间隔:" << config.checkInterval() << "秒";
+
+  // 本地前端通过控制通道共享本进程的状态轮询; 通道被占用说明
+  // 已有实例在运行, 或有其他进程冒用了该名称, 都不应继续
+  if (!m_ipcServer->listen(socketName)) {
+    qCritical().noquote() << "本地控制通道不可用:"
+                          << m_ipcServer->errorString();
+    return false;
+  }
+  qInfo() << "本地控制通道:" << socketName;
+
+  qint64 watchdogUsec = SdNotify::watchdogUsec();
+  if (watchdogUsec > 0) {
+    // 以看门狗超时的一半为周期, 留出调度余量
+    int interval = qMax<qint64>(watchdogUsec / 2000, 500);
+    m_watchdogTimer->start(interval);
+    qInfo() << "systemd 看门狗已启用, 周期" << interval << "ms";
+  }
+
+  // 守护进程只需判断是否空闲, 以较低频率采样
+  m_throughputSampler->start(m_api->portalUrl().host(), 5000);
+
+  SdNotify::notify("STATUS=等待网络就绪");
+  m_bootSequence->start();
+  // 重启时会话多半仍然有效: 先确认状态, 避免就绪后重复登录
+  if (m_stateSnapshot->isStale())
+    m_controller->warmStart();
+  return true;
+}
+
+void GuardDaemon::onBootFinished(qint64 elapsedMs) {
+  qInfo() << "网络就绪检测结束, 用时" << elapsedMs << "ms";
+  if (m_stopping)
+    return;
+  m_controller->start();
+  m_controller->bootFinished();
+}
+
+void GuardDaemon::onBootTimedOut(qint64 elapsedMs) {
+  // 配置的认证服务器始终不可连接, 尝试发现新地址
+  m_portalDiscovery->discover();
+  onBootFinished(elapsedMs);
+}
+
+void GuardDaemon::applyControllerSettings() {
+  const Config &config = Config::instance();
+  if (config.username().isEmpty() || config.password().isEmpty())
+    qWarning() << "未配置用户名或密码, 不会自动登录";
+  m_controller->setCredentials(config.username(), config.password());
+  m_controller->setAutoLogin(config.autoLogin());
+  m_controller->setCheckInterval(config.checkInterval() * 1000);
+}
+
+void GuardDaemon::onStatusChecked(bool online, const QString &ip,
+                                  qint64 bytesUsed, qint64 secondsOnline) {
+  Q_UNUSED(bytesUsed);
+  Q_UNUSED(secondsOnline);
+
+  m_lastStatus.start();
+  bool wasOnline = m_isOnline;
+  bool firstResult = !m_ready;
+  m_isOnline = online;
+
+  if (firstResult) {
+    // 首次状态检测完成才算就绪
+    m_ready = true;
+    qint64 elapsed = m_startClock.elapsed();
+    Metrics::instance().set("daemon_ready_ms", elapsed);
+    qInfo() << "守护进程就绪, 启动用时" << elapsed << "ms";
+    SdNotify::notify("READY=1");
+  }
+
+  if (online != wasOnline || firstResult) {
+    qInfo().noquote() << (online ? QString("在线 - IP: %1").arg(ip)
+                                 : QString("离线"));
+  }
+  SdNotify::notify(online ? QByteArray("STATUS=在线 ") + ip.toUtf8()
+                          : QByteArray("STATUS=离线"));
+}
+
+void GuardDaemon::onLoginSuccess(const QString &message) {
+  qInfo().noquote() << "登录成功:" << message;
+}
+
+void GuardDaemon::onLoginFailed(const QString &error, PortalError::Code code,
+                                PortalError::Policy policy) {
+  Q_UNUSED(code);
+  if (policy == PortalError::Policy::Stop) {
+    qCritical().noquote() << "登录失败:" << error
+                          << "- 重试无效, 已停止自动登录, 修正配置后 reload";
+    SdNotify::notify("STATUS=登录失败, 已停止自动登录");
+    return;
+  }
+  qWarning().noquote() << "登录失败:" << error << "- 将按错误策略重试";
+}
+
+void GuardDaemon::onRequestRejected(Api::Operation operation,
+                                    const QString &reason) {
+  qWarning().noquote() << "请求被拦截:" << reason;
+  // 被拦截的状态检测也说明轮询循环仍在运行
+  if (operation == Api::Operation::Status)
+    m_lastStatus.start();
+  if (m_stopping && operation == Api::Operation::Logout)
+    finishShutdown();
+}
+
+bool GuardDaemon::pollLoopHealthy() const {
+  // 轮询启动前 (等待网络就绪) 以启动时间计算; 低功耗暂停时按兜底检测周期
+  qint64 limit = m_controller->pollIntervalMs() * 2 + 10000;
+  if (!m_lastStatus.isValid())
+    return m_startClock.elapsed() < limit + 45000;
+  return m_lastStatus.elapsed() < limit;
+}
+
+void GuardDaemon::onWatchdog() {
+  PowerMonitor::countWakeup();
+  // 事件循环卡死时本定时器不会触发; 轮询长时间没有结果时也停止喂狗,
+  // 两种情况都由 systemd 重启进程
+  if (pollLoopHealthy()) {
+    SdNotify::notify("WATCHDOG=1");
+  } else {
+    qWarning() << "轮询循环无响应, 停止发送看门狗心跳";
+  }
+}
+
+void GuardDaemon::onSignal() {
+  char signo = 0;
+  if (::read(s_signalFd[1], &signo, 1) != 1)
+    return;
+
+  if (signo == SIGHUP) {
+    reload();
+  } else {
+    shutdown();
+  }
+}
+
+void GuardDaemon::reload() {
+  SdNotify::notify("RELOADING=1");
+
+  Config &config = Config::instance();
+  config.load();
+  m_api->setDirectRoute(config.directRoute());
+  m_api->setProfile(config.portalProfile());
+  m_portalDiscovery->applyCache();
+  applyControllerSettings();
+  m_controller->resume();
+
+  qInfo() << "配置已重新加载, 检测间隔:" << config.checkInterval() << "秒";
+  SdNotify::notify("READY=1");
+  if (!m_stopping)
+    m_controller->checkNow();
+}
+
+void GuardDaemon::shutdown() {
+  if (m_stopping)
+    return;
+  m_stopping = true;
+
+  SdNotify::notify("STOPPING=1");
+  m_controller->stop();
+  m_bootSequence->stop();
+
+  if (!m_isOnline) {
+    finishShutdown();
+    return;
+  }
+
+  // 限时注销: 超时直接退出, 不阻塞 systemd 的停止流程
+  qInfo() << "正在注销...";
+  connect(m_api, &Api::logoutSuccess, this, &GuardDaemon::finishShutdown);
+  connect(m_api, &Api::logoutFailed, this, &GuardDaemon::finishShutdown);
+  m_shutdownTimer->start(LOGOUT_TIMEOUT_MS);
+  m_api->logout();
+}
+
+void GuardDaemon::finishShutdown() {
+  m_shutdownTimer->stop();
+  qInfo() << "守护进程退出";
+  QCoreApplication::quit();
+}
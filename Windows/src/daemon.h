@@ -0,0 +1,82 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include "api.h"
+#include "bootsequence.h"
+#include "guardclock.h"
+#include "guardcontroller.h"
+#include "ipcserver.h"
+#include "portaldiscovery.h"
+#include "powermonitor.h"
+#include "statesnapshot.h"
+#include "throughputsampler.h"
+
+// Linux 无界面守护进程: 复用 Api/Config 逻辑, 与 systemd 集成
+// - Type=notify: 首次状态检测完成后才发送 READY=1
+// - 看门狗: 仅在轮询循环健康时发送 WATCHDOG=1
+// - SIGHUP 重新加载配置, SIGTERM/SIGINT 限时注销后退出
+// - 休眠唤醒/网卡获得地址时立即检测, 电池供电且会话稳定时暂停常规检测
+class GuardDaemon : public QObject {
+  Q_OBJECT
+
+public:
+  explicit GuardDaemon(QObject *parent = nullptr);
+  ~GuardDaemon();
+
+  // 安装信号处理 (需在 start 之前调用)
+  static bool installSignalHandlers();
+
+  // 本地控制通道无法监听时返回 false, 调用方应以非零状态退出
+  bool start(const QString &socketName = IpcProtocol::serverName());
+
+private slots:
+  void onBootFinished(qint64 elapsedMs);
+  void onBootTimedOut(qint64 elapsedMs);
+  void onStatusChecked(bool online, const QString &ip, qint64 bytesUsed,
+                       qint64 secondsOnline);
+  void onLoginSuccess(const QString &message);
+  void onLoginFailed(const QString &error, PortalError::Code code,
+                     PortalError::Policy policy);
+  void onRequestRejected(Api::Operation operation, const QString &reason);
+  void onSignal();
+  void onWatchdog();
+
+private:
+  void reload();
+  void shutdown();
+  void finishShutdown();
+  void applyControllerSettings();
+  bool pollLoopHealthy() const;
+
+  Api *m_api;
+  BootSequence *m_bootSequence;
+  IpcServer *m_ipcServer;
+  PortalDiscovery *m_portalDiscovery;
+  PowerMonitor *m_powerMonitor;
+  StateSnapshot *m_stateSnapshot;
+  ThroughputSampler *m_throughputSampler;
+  SystemClock *m_clock;
+  GuardController *m_controller;
+  QTimer *m_watchdogTimer;
+  QTimer *m_shutdownTimer;
+  QSocketNotifier *m_signalNotifier = nullptr;
+
+  QElapsedTimer m_startClock;
+  QElapsedTimer m_lastStatus;
+
+  bool m_ready = false;
+  bool m_isOnline = false;
+  bool m_stopping = false;
+
+  static int s_signalFd[2];
+  static void signalHandler(int signo);
+
+  static const int LOGOUT_TIMEOUT_MS;
+};
+
+#endif // DAEMON_H
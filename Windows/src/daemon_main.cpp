@@ -0,0 +1,55 @@
+#include "config.h"
+#include "daemon.h"
+#include "proxycache.h"
+#include "tracer.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+
+  app.setApplicationName("HAUTNetworkGuard");
+  app.setApplicationVersion("1.3.5");
+  app.setOrganizationName("YellowPeach");
+
+  // 日志输出到 stderr, 带 syslog 优先级前缀供 journald 识别
+  qSetMessagePattern("%{if-debug}<7>%{endif}%{if-info}<6>%{endif}"
+                     "%{if-warning}<4>%{endif}%{if-critical}<3>%{endif}"
+                     "%{if-fatal}<2>%{endif}%{message}");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("HAUT Network Guard 守护进程");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  QCommandLineOption configOption(
+      QStringList() << "c" << "config", "INI 配置文件路径", "file");
+  parser.addOption(configOption);
+  QCommandLineOption socketOption("socket", "本地控制通道名称或套接字路径",
+                                  "name", IpcProtocol::serverName());
+  parser.addOption(socketOption);
+  QCommandLineOption traceOption(
+      "trace", "记录请求与决策时间线, 退出时写入 Chrome trace JSON", "file");
+  parser.addOption(traceOption);
+  parser.process(app);
+
+  if (parser.isSet(traceOption))
+    Tracer::instance().enable(parser.value(traceOption));
+
+  Config &config = Config::instance();
+  if (parser.isSet(configOption)) {
+    config.setFilePath(parser.value(configOption));
+    config.load();
+  }
+
+  CachingProxyFactory::install();
+
+  if (!GuardDaemon::installSignalHandlers())
+    qWarning() << "信号处理安装失败";
+
+  GuardDaemon daemon;
+  if (!daemon.start(parser.value(socketOption)))
+    return 1;
+
+  return app.exec();
+}
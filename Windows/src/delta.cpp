@@ -0,0 +1,178 @@
+#include "delta.h"
+#include <QDataStream>
+#include <QHash>
+#include <cstring>
+
+const char Delta::MAGIC[9] = "HNGDIFF1";
+// 旧文件按 16 字节分块建索引, 不短于 31 字节的相同片段一定能被找到
+const int Delta::BLOCK = 16;
+const int Delta::COMPRESSION_LEVEL = 9;
+// 校验补丁声明的输出大小, 客户端的任何单个文件都远小于此
+const qint64 Delta::MAX_SIZE = 512 * 1024 * 1024;
+
+namespace {
+
+quint64 hashBlock(const uchar *data, int size) {
+  quint64 hash = 14695981039346656037ULL;
+  for (int i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+void setError(QString *error, const QString &message) {
+  if (error)
+    *error = message;
+}
+
+} // namespace
+
+QByteArray Delta::diff(const QByteArray &oldData, const QByteArray &newData) {
+  const uchar *oldBytes = reinterpret_cast<const uchar *>(oldData.constData());
+  const uchar *newBytes = reinterpret_cast<const uchar *>(newData.constData());
+  const qint64 oldSize = oldData.size();
+  const qint64 newSize = newData.size();
+
+  QHash<quint64, qint64> index;
+  index.reserve(oldSize / BLOCK);
+  for (qint64 i = 0; i + BLOCK <= oldSize; i += BLOCK)
+    index.insert(hashBlock(oldBytes + i, BLOCK), i);
+
+  QByteArray control, diffBlock, extraBlock;
+  QDataStream controlStream(&control, QIODevice::WriteOnly);
+  diffBlock.reserve(newSize);
+
+  // lastScan/lastPos: 上一个匹配在新/旧文件中的起点
+  qint64 scan = 0, lastScan = 0, lastPos = 0;
+  while (scan < newSize) {
+    qint64 pos = -1, length = 0;
+    for (; scan + BLOCK <= newSize; ++scan) {
+      // 沿当前对齐继续相同的字节由差值段覆盖, 不必另找匹配
+      const qint64 aligned = lastPos + (scan - lastScan);
+      if (aligned < oldSize && oldBytes[aligned] == newBytes[scan])
+        continue;
+      auto it = index.constFind(hashBlock(newBytes + scan, BLOCK));
+      if (it == index.constEnd() ||
+          memcmp(oldBytes + *it, newBytes + scan, BLOCK) != 0)
+        continue;
+      pos = *it;
+      length = BLOCK;
+      while (scan + length < newSize && pos + length < oldSize &&
+             newBytes[scan + length] == oldBytes[pos + length])
+        ++length;
+      break;
+    }
+    if (pos < 0)
+      scan = newSize;
+
+    // 差值段从上一个匹配向前延伸, 只要相同字节多于一半就值得按差值编码
+    qint64 forward = 0;
+    for (qint64 i = 0, same = 0, best = 0;
+         lastScan + i < scan && lastPos + i < oldSize;) {
+      if (oldBytes[lastPos + i] == newBytes[lastScan + i])
+        ++same;
+      ++i;
+      if (same * 2 - i > best * 2 - forward) {
+        best = same;
+        forward = i;
+      }
+    }
+
+    // 新匹配同样向后延伸, 但不与前一段重叠
+    qint64 backward = 0;
+    if (pos >= 0) {
+      for (qint64 i = 1, same = 0, best = 0;
+           scan - i >= lastScan + forward && pos - i >= 0; ++i) {
+        if (oldBytes[pos - i] == newBytes[scan - i])
+          ++same;
+        if (same * 2 - i > best * 2 - backward) {
+          best = same;
+          backward = i;
+        }
+      }
+    }
+
+    for (qint64 i = 0; i < forward; ++i)
+      diffBlock.append(char(newBytes[lastScan + i] - oldBytes[lastPos + i]));
+    const qint64 extraStart = lastScan + forward;
+    const qint64 extraEnd = pos >= 0 ? scan - backward : newSize;
+    extraBlock.append(newData.constData() + extraStart, extraEnd - extraStart);
+    const qint64 nextPos = pos >= 0 ? pos - backward : lastPos + forward;
+    controlStream << forward << (extraEnd - extraStart)
+                  << (nextPos - (lastPos + forward));
+
+    if (pos < 0)
+      break;
+    lastScan = scan - backward;
+    lastPos = pos - backward;
+    scan += length;
+  }
+
+  QByteArray patch;
+  QDataStream stream(&patch, QIODevice::WriteOnly);
+  stream.writeRawData(MAGIC, 8);
+  stream << oldSize << newSize << qCompress(control, COMPRESSION_LEVEL)
+         << qCompress(diffBlock, COMPRESSION_LEVEL)
+         << qCompress(extraBlock, COMPRESSION_LEVEL);
+  return patch;
+}
+
+bool Delta::apply(const QByteArray &oldData, const QByteArray &patch,
+                  QByteArray *newData, QString *error) {
+  QDataStream stream(patch);
+  char magic[8];
+  if (stream.readRawData(magic, 8) != 8 || memcmp(magic, MAGIC, 8) != 0) {
+    setError(error, "不是有效的差分补丁");
+    return false;
+  }
+
+  qint64 oldSize = 0, newSize = 0;
+  QByteArray control, diffBlock, extraBlock;
+  stream >> oldSize >> newSize >> control >> diffBlock >> extraBlock;
+  if (stream.status() != QDataStream::Ok || newSize < 0 ||
+      newSize > MAX_SIZE) {
+    setError(error, "差分补丁已损坏");
+    return false;
+  }
+  if (oldSize != oldData.size()) {
+    setError(error, "差分补丁与当前版本不符");
+    return false;
+  }
+  control = qUncompress(control);
+  diffBlock = qUncompress(diffBlock);
+  extraBlock = qUncompress(extraBlock);
+
+  const char *oldBytes = oldData.constData();
+  QByteArray result;
+  result.reserve(newSize);
+  QDataStream controlStream(control);
+  qint64 oldPos = 0, diffPos = 0, extraPos = 0;
+  while (!controlStream.atEnd()) {
+    qint64 diffLength = 0, extraLength = 0, seek = 0;
+    controlStream >> diffLength >> extraLength >> seek;
+    // 补丁来自网络, 越界的控制项一律视为损坏
+    if (controlStream.status() != QDataStream::Ok || diffLength < 0 ||
+        extraLength < 0 || oldPos < 0 || oldPos + diffLength > oldSize ||
+        diffPos + diffLength > diffBlock.size() ||
+        extraPos + extraLength > extraBlock.size() ||
+        result.size() + diffLength + extraLength > newSize) {
+      setError(error, "差分补丁已损坏");
+      return false;
+    }
+
+    for (qint64 i = 0; i < diffLength; ++i)
+      result.append(char(oldBytes[oldPos + i] + diffBlock[diffPos + i]));
+    result.append(extraBlock.constData() + extraPos, extraLength);
+    oldPos += diffLength + seek;
+    diffPos += diffLength;
+    extraPos += extraLength;
+  }
+
+  if (result.size() != newSize) {
+    setError(error, "差分补丁已损坏");
+    return false;
+  }
+  *newData = result;
+  return true;
+}
@@ -0,0 +1,25 @@
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <QByteArray>
+#include <QString>
+
+// bsdiff 式二进制差分: 新文件由若干 (差值段, 新增段, 旧文件跳转) 描述,
+// 差值段是新旧文件对齐位置的逐字节差, 代码移位后绝大部分为 0.
+// 控制/差值/新增三路分别 zlib 压缩, 小版本升级的补丁通常只有完整文件的几个百分点
+class Delta {
+public:
+  static QByteArray diff(const QByteArray &oldData, const QByteArray &newData);
+
+  // 补丁损坏或与旧文件不匹配时返回 false, error 给出原因
+  static bool apply(const QByteArray &oldData, const QByteArray &patch,
+                    QByteArray *newData, QString *error = nullptr);
+
+private:
+  static const char MAGIC[9];
+  static const int BLOCK;
+  static const int COMPRESSION_LEVEL;
+  static const qint64 MAX_SIZE;
+};
+
+#endif // DELTA_H
@@ -0,0 +1,245 @@
+#include "delta.h"
+#include "updater.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QTextStream>
+
+// 增量更新的发布与演练工具:
+//   diff/apply     生成/应用单个文件的差分补丁
+//   manifest       由新版本目录与若干旧版本目录生成清单、完整文件与补丁
+//   update         以指定目录作为安装目录执行一次完整更新 (可对本地 HTTP 服务演练)
+namespace {
+
+QTextStream &out() {
+  static QTextStream stream(stdout);
+  return stream;
+}
+
+QTextStream &err() {
+  static QTextStream stream(stderr);
+  return stream;
+}
+
+bool readFile(const QString &path, QByteArray *data) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    err() << "无法读取 " << path << Qt::endl;
+    return false;
+  }
+  *data = file.readAll();
+  return true;
+}
+
+bool writeFile(const QString &path, const QByteArray &data) {
+  QDir().mkpath(QFileInfo(path).absolutePath());
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+      file.write(data) != data.size()) {
+    err() << "无法写入 " << path << Qt::endl;
+    return false;
+  }
+  return true;
+}
+
+QString hexHash(const QByteArray &data) {
+  return QString::fromLatin1(
+      QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+}
+
+int runDiff(const QStringList &args) {
+  QByteArray oldData, newData;
+  if (args.size() != 3)
+    return 2;
+  if (!readFile(args[0], &oldData) || !readFile(args[1], &newData))
+    return 1;
+  const QByteArray patch = Delta::diff(oldData, newData);
+  if (!writeFile(args[2], patch))
+    return 1;
+  out() << "new=" << newData.size() << " patch=" << patch.size() << " ratio="
+        << QString::number(100.0 * patch.size() / qMax<qint64>(1, newData.size()), 'f',
+                           2)
+        << "%" << Qt::endl;
+  return 0;
+}
+
+int runApply(const QStringList &args) {
+  QByteArray oldData, patch, newData;
+  if (args.size() != 3)
+    return 2;
+  if (!readFile(args[0], &oldData) || !readFile(args[1], &patch))
+    return 1;
+  QString error;
+  if (!Delta::apply(oldData, patch, &newData, &error)) {
+    err() << error << Qt::endl;
+    return 1;
+  }
+  if (!writeFile(args[2], newData))
+    return 1;
+  out() << "sha256=" << hexHash(newData) << Qt::endl;
+  return 0;
+}
+
+// manifest <版本> <新版本目录> <输出目录> [旧版本目录...]
+int runManifest(const QStringList &args, qint64 packageSize) {
+  if (args.size() < 3)
+    return 2;
+  const QString version = args[0];
+  const QDir newDir(args[1]);
+  const QDir outDir(args[2]);
+  const QStringList oldDirs = args.mid(3);
+
+  QJsonArray files;
+  qint64 totalSize = 0, totalPatches = 0;
+  QDirIterator it(newDir.absolutePath(), QDir::Files,
+                  QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    const QString path = newDir.relativeFilePath(it.next());
+    QByteArray newData;
+    if (!readFile(newDir.filePath(path), &newData) ||
+        !writeFile(outDir.filePath("full/" + path), newData))
+      return 1;
+    const QString hash = hexHash(newData);
+
+    QJsonArray patches;
+    QSet<QString> seen{hash};
+    for (const QString &oldPath : oldDirs) {
+      QByteArray oldData;
+      const QString oldFile = QDir(oldPath).filePath(path);
+      if (!QFileInfo::exists(oldFile) || !readFile(oldFile, &oldData))
+        continue;
+      const QString from = hexHash(oldData);
+      if (seen.contains(from))
+        continue;
+      seen.insert(from);
+
+      const QByteArray patch = Delta::diff(oldData, newData);
+      if (patch.size() >= newData.size())
+        continue;
+      const QString url = "patches/" + path + "." + from.left(12) + ".hngd";
+      if (!writeFile(outDir.filePath(url), patch))
+        return 1;
+      patches.append(QJsonObject{{"from", from},
+                                 {"url", url},
+                                 {"size", qint64(patch.size())},
+                                 {"sha256", hexHash(patch)}});
+      totalPatches += patch.size();
+      out() << path << ": " << oldPath << " -> patch " << patch.size() << " / "
+            << newData.size() << Qt::endl;
+    }
+
+    QJsonObject file{{"path", path},
+                     {"size", qint64(newData.size())},
+                     {"sha256", hash},
+                     {"url", "full/" + path}};
+    if (!patches.isEmpty())
+      file.insert("patches", patches);
+    files.append(file);
+    totalSize += newData.size();
+  }
+
+  QJsonObject manifest{{"version", version}, {"files", files}};
+  if (packageSize > 0)
+    manifest.insert("package_size", packageSize);
+  if (!writeFile(outDir.filePath("manifest.json"),
+                 QJsonDocument(manifest).toJson()))
+    return 1;
+  out() << "files=" << files.size() << " full=" << totalSize
+        << " patches=" << totalPatches << Qt::endl;
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  app.setApplicationName("haut-network-guard-delta");
+  app.setApplicationVersion("1.3.5");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("HAUT Network Guard 增量更新工具");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  parser.addPositionalArgument("command", "diff | apply | manifest | update");
+  QCommandLineOption dirOption("dir", "update: 安装目录", "path",
+                               QDir::currentPath());
+  QCommandLineOption currentOption("current", "update: 视为已安装的版本",
+                                   "version", "0");
+  QCommandLineOption packageOption(
+      "package", "manifest: 完整安装包, 用于统计节省的流量", "file");
+  parser.addOption(dirOption);
+  parser.addOption(currentOption);
+  parser.addOption(packageOption);
+  parser.process(app);
+
+  QStringList args = parser.positionalArguments();
+  const QString command = args.isEmpty() ? QString() : args.takeFirst();
+  if (command == "diff" || command == "apply" || command == "manifest") {
+    int result = 2;
+    if (command == "diff")
+      result = runDiff(args);
+    else if (command == "apply")
+      result = runApply(args);
+    else
+      result = runManifest(
+          args, parser.isSet(packageOption)
+                    ? QFileInfo(parser.value(packageOption)).size()
+                    : 0);
+    // 返回 2 表示参数错误
+    if (result == 2)
+      parser.showHelp(2);
+    return result;
+  }
+  if (command != "update" || args.size() != 1)
+    parser.showHelp(2);
+
+  Updater updater;
+  updater.setInstallDir(parser.value(dirOption));
+  updater.setCurrentVersion(
+      QVersionNumber::fromString(parser.value(currentOption)));
+
+  QObject::connect(&updater, &Updater::failed, &app, [](const QString &error) {
+    err() << error << Qt::endl;
+    QCoreApplication::exit(1);
+  });
+  QObject::connect(&updater, &Updater::upToDate, &app, []() {
+    out() << "已是最新版本" << Qt::endl;
+    QCoreApplication::exit(0);
+  });
+  QObject::connect(&updater, &Updater::updateAvailable, &app,
+                   [&updater](const QString &version, const QString &notes,
+                              qint64 downloadBytes, qint64 fullBytes) {
+                     Q_UNUSED(notes);
+                     out() << "version=" << version
+                           << " download=" << downloadBytes
+                           << " full=" << fullBytes << Qt::endl;
+                     updater.download();
+                   });
+  QObject::connect(
+      &updater, &Updater::readyToApply, &app,
+      [&updater](qint64 downloadedBytes, qint64 fullBytes) {
+        QString error;
+        if (!updater.apply(&error)) {
+          err() << error << Qt::endl;
+          QCoreApplication::exit(1);
+          return;
+        }
+        out() << "applied downloaded=" << downloadedBytes
+              << " full=" << fullBytes
+              << " saved=" << qMax<qint64>(0, fullBytes - downloadedBytes)
+              << Qt::endl;
+        QCoreApplication::exit(0);
+      });
+
+  Updater::cleanup(updater.installDir());
+  updater.check(QUrl::fromUserInput(args.first()));
+  return app.exec();
+}
@@ -15,9 +15,6 @@ public:
   // MD5 哈希
   static QString md5Hash(const QString &input);
   static QString md5Hash(const QByteArray &input);
-
-private:
-  static const QString PASSWORD_KEY;
 };
 
 #endif // ENCRYPTION_H
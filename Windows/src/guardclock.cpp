@@ -0,0 +1,36 @@
+#include "guardclock.h"
+#include "powermonitor.h"
+
+// 较长的延时允许秒级误差, 与系统中其它粗粒度定时器合并唤醒
+const qint64 SystemClock::VERY_COARSE_MIN_MS = 5000;
+
+SystemClock::SystemClock(QObject *parent) : QObject(parent) {
+  m_clock.start();
+}
+
+qint64 SystemClock::nowMs() const { return m_clock.elapsed(); }
+
+int SystemClock::schedule(qint64 delayMs, std::function<void()> callback) {
+  const int id = ++m_nextId;
+
+  QTimer *timer = new QTimer(this);
+  timer->setSingleShot(true);
+  timer->setTimerType(delayMs >= VERY_COARSE_MIN_MS ? Qt::VeryCoarseTimer
+                                                    : Qt::CoarseTimer);
+  m_timers.insert(id, timer);
+  connect(timer, &QTimer::timeout, this, [this, id, callback]() {
+    if (QTimer *fired = m_timers.take(id))
+      fired->deleteLater();
+    PowerMonitor::countWakeup();
+    callback();
+  });
+  timer->start(static_cast<int>(qMax<qint64>(0, delayMs)));
+  return id;
+}
+
+void SystemClock::cancel(int id) {
+  if (QTimer *timer = m_timers.take(id)) {
+    timer->stop();
+    timer->deleteLater();
+  }
+}
@@ -0,0 +1,42 @@
+#ifndef GUARDCLOCK_H
+#define GUARDCLOCK_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include <functional>
+
+// 守护逻辑使用的时钟与定时器抽象, 便于在仿真中以虚拟时间运行
+class GuardClock {
+public:
+  virtual ~GuardClock() = default;
+
+  // 单调时间 (毫秒)
+  virtual qint64 nowMs() const = 0;
+
+  // delayMs 后执行 callback, 返回定时器 id (始终大于 0)
+  virtual int schedule(qint64 delayMs, std::function<void()> callback) = 0;
+  virtual void cancel(int id) = 0;
+};
+
+// 基于 QTimer 的真实时钟
+class SystemClock : public QObject, public GuardClock {
+  Q_OBJECT
+
+public:
+  explicit SystemClock(QObject *parent = nullptr);
+
+  qint64 nowMs() const override;
+  int schedule(qint64 delayMs, std::function<void()> callback) override;
+  void cancel(int id) override;
+
+private:
+  QElapsedTimer m_clock;
+  QHash<int, QTimer *> m_timers;
+  int m_nextId = 0;
+
+  static const qint64 VERY_COARSE_MIN_MS;
+};
+
+#endif // GUARDCLOCK_H
@@ -0,0 +1,448 @@
+#include "guardcontroller.h"
+#include "metrics.h"
+#include "tracer.h"
+#include <QDebug>
+
+// 预测到期前至少提前 1 分钟 (且不少于一个检测周期) 刷新,
+// 在此之前的 10 分钟内等待低流量时刻
+const qint64 GuardController::REFRESH_LEAD_MS = 60 * 1000;
+const qint64 GuardController::QUIET_WINDOW_MS = 10 * 60 * 1000;
+const qint64 GuardController::QUIET_RECHECK_MS = 15 * 1000;
+const qint64 GuardController::KEEPALIVE_LEAD_MS = 2 * 60 * 1000;
+// 低功耗时: 连续在线 5 分钟视为会话稳定, 之后只保留 10 分钟一次的兜底检测
+const qint64 GuardController::STABLE_MS = 5 * 60 * 1000;
+const qint64 GuardController::SUSPENDED_POLL_MS = 10 * 60 * 1000;
+// 唤醒与网卡事件往往相继到达, 合并为一次检测
+const qint64 GuardController::WAKE_DEBOUNCE_MS = 2000;
+
+GuardController::GuardController(GuardClock *clock, GuardTransport *transport,
+                                 QObject *parent)
+    : QObject(parent), m_clock(clock), m_transport(transport) {
+  m_startMs = m_clock->nowMs();
+
+  connect(m_transport, &GuardTransport::statusChecked, this,
+          &GuardController::onStatusChecked);
+  connect(m_transport, &GuardTransport::loginSucceeded, this,
+          &GuardController::onLoginSucceeded);
+  connect(m_transport, &GuardTransport::loginFailed, this,
+          &GuardController::onLoginFailed);
+  connect(m_transport, &GuardTransport::logoutSucceeded, this,
+          &GuardController::onLogoutSucceeded);
+  connect(m_transport, &GuardTransport::logoutFailed, this,
+          &GuardController::onLogoutFailed);
+  connect(m_transport, &GuardTransport::requestRejected, this,
+          &GuardController::onRequestRejected);
+}
+
+GuardController::~GuardController() { stop(); }
+
+void GuardController::setCredentials(const QString &username,
+                                     const QString &password) {
+  m_username = username;
+  m_password = password;
+}
+
+void GuardController::setAutoLogin(bool enabled) {
+  m_autoLogin = enabled;
+  if (!enabled)
+    cancelRetry();
+}
+
+void GuardController::setCheckInterval(qint64 intervalMs) {
+  m_intervalMs = intervalMs;
+  if (m_running)
+    schedulePoll();
+}
+
+void GuardController::setRandomGenerator(QRandomGenerator *rng) {
+  m_loginRetry.setRandomGenerator(rng);
+}
+
+void GuardController::setQuietCheck(std::function<bool()> quiet) {
+  m_quiet = std::move(quiet);
+}
+
+void GuardController::setLowPowerCheck(std::function<bool()> lowPower) {
+  m_lowPower = std::move(lowPower);
+}
+
+void GuardController::start() {
+  m_running = true;
+  schedulePoll();
+}
+
+void GuardController::stop() {
+  m_running = false;
+  if (m_pollTimer) {
+    m_clock->cancel(m_pollTimer);
+    m_pollTimer = 0;
+  }
+  cancelRetry();
+  cancelRefresh();
+}
+
+void GuardController::bootFinished() {
+  m_bootReady = true;
+  // 快照确认中或已确认在线: 结果到达时按在线/离线正常处理
+  if (m_verifying || m_isOnline)
+    return;
+  checkNow();
+}
+
+void GuardController::warmStart() {
+  Tracer::instant("guard", "warm_start");
+  m_verifying = true;
+  checkNow();
+}
+
+void GuardController::checkNow() {
+  Tracer::instant("guard", "check_status");
+  ++m_stats.statusRequests;
+  m_transport->checkStatus();
+}
+
+void GuardController::manualLogin(const QString &username,
+                                  const QString &password) {
+  m_suppressAutoLogin = false;
+  m_loginRetry.reset();
+  cancelRetry();
+
+  ++m_stats.loginRequests;
+  m_loginInFlight = true;
+  m_transport->login(username, password);
+}
+
+void GuardController::manualLogout() {
+  m_suppressAutoLogin = true;
+  cancelRetry();
+  cancelRefresh();
+  // 刷新中的注销结果不再触发重新登录
+  if (m_refreshing)
+    finishRefresh(false);
+  m_session.sessionEnded();
+  m_transport->logout();
+}
+
+void GuardController::resume() {
+  m_suppressAutoLogin = false;
+  m_startupLoginAttempted = false;
+  m_loginRetry.reset();
+  cancelRetry();
+}
+
+void GuardController::wake() {
+  const qint64 now = m_clock->nowMs();
+  if (!m_running || !m_bootReady ||
+      (m_lastWakeMs >= 0 && now - m_lastWakeMs < WAKE_DEBOUNCE_MS))
+    return;
+
+  Tracer::instant("guard", "wake");
+  m_lastWakeMs = now;
+  ++m_stats.wakeChecks;
+  // 网络环境已变化, 不再等待原来的退避; 密码错误等暂停状态保持不变
+  m_wakeLogin = true;
+  cancelRetry();
+  checkNow();
+  schedulePoll();
+}
+
+void GuardController::powerStateChanged() {
+  if (!m_running)
+    return;
+  const bool wasSuspended = m_pollSuspended;
+  schedulePoll();
+  if (wasSuspended && !m_pollSuspended)
+    checkNow();
+}
+
+bool GuardController::sessionStable(qint64 now) const {
+  // 学到空闲超时时需要按时检测以发送保活流量, 不算稳定
+  return m_isOnline && m_onlineSince >= 0 && now - m_onlineSince >= STABLE_MS &&
+         !m_loginInFlight && !m_retryTimer && !m_refreshing &&
+         m_session.predictedIdleMs() < 0;
+}
+
+void GuardController::schedulePoll() {
+  if (m_pollTimer)
+    m_clock->cancel(m_pollTimer);
+
+  const bool suspended =
+      m_lowPower && sessionStable(m_clock->nowMs()) && m_lowPower();
+  if (suspended != m_pollSuspended) {
+    m_pollSuspended = suspended;
+    Tracer::instant("guard", suspended ? "poll_suspended" : "poll_resumed");
+    Metrics::instance().set("poll_suspended", suspended ? 1 : 0);
+  }
+
+  m_pollTimer = m_clock->schedule(pollIntervalMs(), [this]() { poll(); });
+}
+
+qint64 GuardController::pollIntervalMs() const {
+  return m_pollSuspended ? qMax(SUSPENDED_POLL_MS, m_intervalMs) : m_intervalMs;
+}
+
+void GuardController::poll() {
+  m_pollTimer = 0;
+  checkNow();
+  if (m_running)
+    schedulePoll();
+}
+
+void GuardController::onStatusChecked(bool online, const QString &ip,
+                                      qint64 bytesUsed, qint64 secondsOnline) {
+  Q_UNUSED(ip);
+
+  const qint64 now = m_clock->nowMs();
+  bool wasOnline = m_isOnline;
+  m_isOnline = online;
+  Tracer::instant("guard", online ? "online" : "offline");
+
+  const bool wakeLogin = m_wakeLogin;
+  m_wakeLogin = false;
+  m_verifying = false;
+
+  if (online) {
+    if (!wasOnline)
+      m_onlineSince = now;
+    if (m_offlineSince >= 0) {
+      m_stats.observedOfflineMs += now - m_offlineSince;
+      m_offlineSince = -1;
+    }
+    m_loginRetry.reset();
+    cancelRetry();
+    if (m_stats.firstOnlineMs < 0) {
+      m_stats.firstOnlineMs = now - m_startMs;
+      emit firstOnline(m_stats.firstOnlineMs);
+    }
+    m_session.onlineSample(now, secondsOnline, bytesUsed);
+    planSessionRefresh(now);
+    maybeKeepAlive(now);
+    return;
+  }
+
+  // 主动刷新期间的离线是预期内的, 由刷新流程重新登录
+  if (m_refreshing)
+    return;
+
+  m_onlineSince = -1;
+  if (wasOnline) {
+    ++m_stats.outages;
+    m_offlineSince = now;
+    m_session.sessionDropped(now);
+    cancelRefresh();
+    publishSessionMetrics();
+  }
+
+  // 只有从在线变为离线、启动就绪后的首次检测或唤醒后的检测才自动登录;
+  // 失败后的重试由重试定时器按错误策略安排
+  bool startupLogin = m_bootReady && !m_startupLoginAttempted;
+  if (wasOnline || startupLogin || wakeLogin) {
+    if (startupLogin)
+      m_startupLoginAttempted = true;
+    autoLogin();
+  }
+}
+
+bool GuardController::canAutoLogin() const {
+  return m_autoLogin && !m_suppressAutoLogin && !m_loginInFlight &&
+         !m_verifying && !m_retryTimer && !m_loginRetry.blocked() &&
+         !m_username.isEmpty() && !m_password.isEmpty();
+}
+
+void GuardController::autoLogin() {
+  if (!canAutoLogin()) {
+    Tracer::instant("guard", "auto_login_skipped");
+    return;
+  }
+  Tracer::instant("guard", "auto_login");
+
+  ++m_stats.loginRequests;
+  m_loginInFlight = true;
+  m_transport->login(m_username, m_password);
+}
+
+void GuardController::onLoginSucceeded() {
+  if (m_refreshing)
+    finishRefresh(true);
+  m_loginInFlight = false;
+  m_loginRetry.reset();
+  cancelRetry();
+  checkNow();
+}
+
+void GuardController::onLoginFailed(const QString &error,
+                                    PortalError::Code code,
+                                    PortalError::Policy policy) {
+  Q_UNUSED(error);
+  Q_UNUSED(code);
+  m_loginInFlight = false;
+  // 刷新后重新登录失败: 转入普通的断线重试流程
+  if (m_refreshing)
+    finishRefresh(false);
+
+  qint64 delay = m_loginRetry.onFailure(policy);
+  if (delay >= 0 && m_autoLogin)
+    scheduleRetry(delay);
+  else
+    Tracer::instant("guard", "login_blocked");
+}
+
+void GuardController::onLogoutSucceeded() {
+  m_isOnline = false;
+  m_offlineSince = -1;
+  m_onlineSince = -1;
+
+  if (m_refreshing) {
+    // 刷新会话: 注销后立即重新登录, 门户侧的在线时长随之归零
+    m_session.sessionEnded();
+    ++m_stats.loginRequests;
+    m_loginInFlight = true;
+    m_transport->login(m_username, m_password);
+  }
+}
+
+void GuardController::onLogoutFailed() {
+  // 会话仍然有效, 到期后按普通掉线处理
+  if (m_refreshing)
+    finishRefresh(false);
+}
+
+void GuardController::onRequestRejected(Api::Operation operation) {
+  switch (operation) {
+  case Api::Operation::Login:
+    // 登录被限流/熔断拦截: 按退避策略稍后重试
+    if (!m_loginInFlight)
+      break;
+    Tracer::instant("guard", "login_rejected");
+    m_loginInFlight = false;
+    if (m_refreshing)
+      finishRefresh(false);
+    if (m_autoLogin)
+      scheduleRetry(m_loginRetry.onFailure(PortalError::Policy::Backoff));
+    break;
+  case Api::Operation::Logout:
+    // 刷新会话的注销被拦截: 会话未受影响, 放弃本次刷新
+    if (m_refreshing) {
+      Tracer::instant("guard", "refresh_rejected");
+      finishRefresh(false);
+    }
+    break;
+  case Api::Operation::Status:
+    // 状态检测被拦截时不会有结果: 快照确认不能一直阻止自动登录,
+    // 改由就绪后的检测或下一次定时检测确认
+    if (m_verifying) {
+      Tracer::instant("guard", "verify_rejected");
+      m_verifying = false;
+    }
+    break;
+  }
+}
+
+void GuardController::scheduleRetry(qint64 delayMs) {
+  cancelRetry();
+  Tracer::instant("guard", "retry_scheduled", "delay_ms", delayMs);
+  m_retryTimer = m_clock->schedule(delayMs, [this]() {
+    m_retryTimer = 0;
+    Tracer::instant("guard", "retry");
+    if (!m_isOnline)
+      autoLogin();
+  });
+}
+
+void GuardController::cancelRetry() {
+  if (m_retryTimer) {
+    m_clock->cancel(m_retryTimer);
+    m_retryTimer = 0;
+  }
+}
+
+void GuardController::planSessionRefresh(qint64 now) {
+  const qint64 lifetime = m_session.predictedLifetimeMs();
+  const qint64 start = m_session.sessionStartMs();
+  // 每个会话只安排一次; 未学到会话寿命或不自动登录时不刷新
+  if (lifetime < 0 || start == m_refreshPlannedFor || !m_autoLogin ||
+      m_suppressAutoLogin || m_username.isEmpty() || m_password.isEmpty())
+    return;
+
+  const qint64 expiry = start + lifetime;
+  if (expiry <= now)
+    return;
+
+  cancelRefresh();
+  m_refreshPlannedFor = start;
+  m_refreshDeadline = expiry - qMax(REFRESH_LEAD_MS, m_intervalMs);
+  // 等待低流量的窗口不早于会话过半
+  const qint64 windowStart =
+      qMax(m_refreshDeadline - QUIET_WINDOW_MS, start + lifetime / 2);
+  Tracer::instant("guard", "refresh_planned", "in_ms", windowStart - now);
+  m_refreshTimer =
+      m_clock->schedule(windowStart - now, [this]() { tryRefresh(); });
+}
+
+void GuardController::tryRefresh() {
+  m_refreshTimer = 0;
+  if (!m_isOnline || m_refreshing || m_loginInFlight)
+    return;
+
+  // 低流量时刻刷新, 最迟到截止时间无条件刷新
+  const qint64 now = m_clock->nowMs();
+  if (now < m_refreshDeadline && m_quiet && !m_quiet()) {
+    Tracer::instant("guard", "refresh_deferred");
+    m_refreshTimer =
+        m_clock->schedule(qMin(QUIET_RECHECK_MS, m_refreshDeadline - now),
+                          [this]() { tryRefresh(); });
+    return;
+  }
+
+  qInfo() << "会话即将到期, 主动刷新";
+  Tracer::instant("guard", "refresh");
+  m_refreshing = true;
+  ++m_stats.refreshes;
+  emit refreshStarted();
+  m_transport->logout();
+}
+
+void GuardController::finishRefresh(bool succeeded) {
+  m_refreshing = false;
+  if (succeeded)
+    ++m_stats.outagesAvoided;
+  else
+    ++m_stats.refreshFailures;
+  publishSessionMetrics();
+  QMetaObject::invokeMethod(
+      this, [this, succeeded]() { emit refreshFinished(succeeded); },
+      Qt::QueuedConnection);
+}
+
+void GuardController::cancelRefresh() {
+  if (m_refreshTimer) {
+    m_clock->cancel(m_refreshTimer);
+    m_refreshTimer = 0;
+  }
+}
+
+void GuardController::maybeKeepAlive(qint64 now) {
+  const qint64 idle = m_session.predictedIdleMs();
+  if (idle < 0)
+    return;
+
+  // 每段空闲期最多发送一次, 发送后的流量会出现在下一次状态查询中
+  const qint64 quiet = now - m_session.lastTrafficMs();
+  const qint64 lead = qMax(KEEPALIVE_LEAD_MS, m_intervalMs * 2);
+  if (quiet >= idle - lead && m_lastKeepAliveMs < m_session.lastTrafficMs()) {
+    m_lastKeepAliveMs = now;
+    Tracer::instant("guard", "keepalive");
+    ++m_stats.keepAlives;
+    m_transport->keepAlive();
+  }
+}
+
+void GuardController::publishSessionMetrics() const {
+  Metrics &metrics = Metrics::instance();
+  metrics.set("session_lifetime_ms", m_session.predictedLifetimeMs());
+  metrics.set("session_idle_timeout_ms", m_session.predictedIdleMs());
+  metrics.set("session_refreshes", m_stats.refreshes);
+  metrics.set("session_refresh_failures", m_stats.refreshFailures);
+  metrics.set("session_outages_avoided", m_stats.outagesAvoided);
+  metrics.set("session_outages", m_stats.outages);
+}
@@ -0,0 +1,154 @@
+#ifndef GUARDCONTROLLER_H
+#define GUARDCONTROLLER_H
+
+#include <QObject>
+#include <QString>
+#include <functional>
+
+#include "guardclock.h"
+#include "guardtransport.h"
+#include "portalerror.h"
+#include "sessionmodel.h"
+
+// 断线重连状态机: 定时检测状态, 启动就绪后首次登录, 掉线后自动登录,
+// 登录失败按错误码策略重试; 学到会话寿命后在到期前择机主动刷新会话.
+// 时钟与传输均可注入, 界面/守护进程/仿真共用
+class GuardController : public QObject {
+  Q_OBJECT
+
+public:
+  struct Stats {
+    qint64 statusRequests = 0;
+    qint64 loginRequests = 0;
+    qint64 firstOnlineMs = -1;     // 启动到首次检测到在线
+    qint64 observedOfflineMs = 0; // 检测到离线至恢复在线的累计时长
+    qint64 outages = 0;           // 在线 -> 离线 次数
+    qint64 refreshes = 0;         // 到期前主动刷新会话次数
+    qint64 refreshFailures = 0;
+    qint64 outagesAvoided = 0; // 刷新成功, 避免了一次门户侧掉线
+    qint64 keepAlives = 0;
+    qint64 wakeChecks = 0; // 休眠唤醒/网络恢复触发的检测
+  };
+
+  GuardController(GuardClock *clock, GuardTransport *transport,
+                  QObject *parent = nullptr);
+  ~GuardController();
+
+  void setCredentials(const QString &username, const QString &password);
+  void setAutoLogin(bool enabled);
+  void setCheckInterval(qint64 intervalMs);
+  void setRandomGenerator(QRandomGenerator *rng);
+  // 当前是否为低流量时刻 (刷新会话会短暂断网), 未设置时视为随时可以
+  void setQuietCheck(std::function<bool()> quiet);
+  // 当前是否为低功耗状态 (显示器关闭/电池供电), 会话稳定时暂停常规检测
+  void setLowPowerCheck(std::function<bool()> lowPower);
+
+  // 开始定时检测
+  void start();
+  void stop();
+
+  // 启动就绪检测结束 (就绪或超时), 立即检测并允许启动登录
+  void bootFinished();
+  // 从上次的状态快照启动: 不等待就绪检测, 立即检测一次状态确认,
+  // 结果返回前不考虑自动登录; 确认在线时就绪后不再重复检测
+  void warmStart();
+
+  void checkNow();
+  // 手动登录/注销: 手动登录解除自动登录暂停, 手动注销后不再自动重连
+  void manualLogin(const QString &username, const QString &password);
+  void manualLogout();
+  // 配置变更后解除自动登录暂停, 下次检测到离线时立即登录
+  void resume();
+  // 休眠唤醒/网卡获得地址: 立即检测, 离线时立即登录
+  void wake();
+  // 低功耗状态变化后重新安排检测; 退出低功耗时立即检测
+  void powerStateChanged();
+
+  bool isOnline() const { return m_isOnline; }
+  bool pollSuspended() const { return m_pollSuspended; }
+  // 当前的检测周期 (低功耗暂停时为兜底检测周期)
+  qint64 pollIntervalMs() const;
+  bool autoLoginBlocked() const { return m_loginRetry.blocked(); }
+  const Stats &stats() const { return m_stats; }
+  const SessionModel &sessionModel() const { return m_session; }
+
+signals:
+  void firstOnline(qint64 elapsedMs);
+  // 主动刷新会话的开始与结束: 其间的注销/重新登录不是用户操作,
+  // 界面、快照与控制通道据此忽略. refreshFinished 在结束刷新的那次
+  // 结果信号分发完毕后才发出, 各接收方的先后顺序不影响判断
+  void refreshStarted();
+  void refreshFinished(bool succeeded);
+
+private slots:
+  void onStatusChecked(bool online, const QString &ip, qint64 bytesUsed,
+                       qint64 secondsOnline);
+  void onLoginSucceeded();
+  void onLoginFailed(const QString &error, PortalError::Code code,
+                     PortalError::Policy policy);
+  void onLogoutSucceeded();
+  void onLogoutFailed();
+  void onRequestRejected(Api::Operation operation);
+
+private:
+  void schedulePoll();
+  void poll();
+  bool sessionStable(qint64 now) const;
+  void autoLogin();
+  void scheduleRetry(qint64 delayMs);
+  void cancelRetry();
+  bool canAutoLogin() const;
+  void planSessionRefresh(qint64 now);
+  void tryRefresh();
+  // 刷新结束 (重新登录成功, 或注销/重新登录失败、被拦截)
+  void finishRefresh(bool succeeded);
+  void cancelRefresh();
+  void maybeKeepAlive(qint64 now);
+  void publishSessionMetrics() const;
+
+  GuardClock *m_clock;
+  GuardTransport *m_transport;
+  LoginRetry m_loginRetry;
+  SessionModel m_session;
+  std::function<bool()> m_quiet;
+  std::function<bool()> m_lowPower;
+
+  QString m_username;
+  QString m_password;
+  bool m_autoLogin = true;
+  qint64 m_intervalMs = 30000;
+
+  int m_pollTimer = 0;
+  int m_retryTimer = 0;
+  int m_refreshTimer = 0;
+  qint64 m_refreshDeadline = 0;
+  qint64 m_refreshPlannedFor = -1; // 已安排刷新的会话 (开始时间)
+  qint64 m_lastKeepAliveMs = -1;
+  qint64 m_startMs = 0;
+  qint64 m_offlineSince = -1;
+  qint64 m_onlineSince = -1;
+  qint64 m_lastWakeMs = -1;
+
+  bool m_running = false;
+  bool m_isOnline = false;
+  bool m_bootReady = false;
+  bool m_startupLoginAttempted = false;
+  bool m_loginInFlight = false;
+  bool m_suppressAutoLogin = false;
+  bool m_refreshing = false;
+  bool m_pollSuspended = false;
+  bool m_wakeLogin = false;
+  bool m_verifying = false;
+
+  Stats m_stats;
+
+  static const qint64 REFRESH_LEAD_MS;
+  static const qint64 QUIET_WINDOW_MS;
+  static const qint64 QUIET_RECHECK_MS;
+  static const qint64 KEEPALIVE_LEAD_MS;
+  static const qint64 STABLE_MS;
+  static const qint64 SUSPENDED_POLL_MS;
+  static const qint64 WAKE_DEBOUNCE_MS;
+};
+
+#endif // GUARDCONTROLLER_H
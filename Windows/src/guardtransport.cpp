@@ -0,0 +1,22 @@
+#include "guardtransport.h"
+
+ApiTransport::ApiTransport(Api *api, QObject *parent)
+    : GuardTransport(parent), m_api(api) {
+  connect(m_api, &Api::statusChecked, this, &GuardTransport::statusChecked);
+  connect(m_api, &Api::loginSuccess, this, &GuardTransport::loginSucceeded);
+  connect(m_api, &Api::loginFailed, this, &GuardTransport::loginFailed);
+  connect(m_api, &Api::logoutSuccess, this, &GuardTransport::logoutSucceeded);
+  connect(m_api, &Api::logoutFailed, this, &GuardTransport::logoutFailed);
+  connect(m_api, &Api::requestRejected, this,
+          &GuardTransport::requestRejected);
+}
+
+void ApiTransport::checkStatus() { m_api->checkStatus(); }
+
+void ApiTransport::login(const QString &username, const QString &password) {
+  m_api->login(username, password);
+}
+
+void ApiTransport::logout() { m_api->logout(); }
+
+void ApiTransport::keepAlive() { m_api->keepAlive(); }
@@ -0,0 +1,51 @@
+#ifndef GUARDTRANSPORT_H
+#define GUARDTRANSPORT_H
+
+#include <QObject>
+#include <QString>
+
+#include "api.h"
+#include "portalerror.h"
+
+// 守护逻辑与认证服务器之间的传输抽象; 真实实现转发 Api,
+// 仿真实现按脚本模拟门户行为
+class GuardTransport : public QObject {
+  Q_OBJECT
+
+public:
+  explicit GuardTransport(QObject *parent = nullptr) : QObject(parent) {}
+
+  virtual void checkStatus() = 0;
+  virtual void login(const QString &username, const QString &password) = 0;
+  virtual void logout() = 0;
+  // 产生少量计费流量, 避免门户判定空闲下线
+  virtual void keepAlive() = 0;
+
+signals:
+  void statusChecked(bool online, const QString &ip, qint64 bytesUsed,
+                     qint64 secondsOnline);
+  void loginSucceeded(const QString &message);
+  void loginFailed(const QString &error, PortalError::Code code,
+                   PortalError::Policy policy);
+  void logoutSucceeded();
+  void logoutFailed(const QString &error);
+  void requestRejected(Api::Operation operation, const QString &reason);
+};
+
+// 基于 Api 的真实传输
+class ApiTransport : public GuardTransport {
+  Q_OBJECT
+
+public:
+  explicit ApiTransport(Api *api, QObject *parent = nullptr);
+
+  void checkStatus() override;
+  void login(const QString &username, const QString &password) override;
+  void logout() override;
+  void keepAlive() override;
+
+private:
+  Api *m_api;
+};
+
+#endif // GUARDTRANSPORT_H
@@ -0,0 +1,64 @@
+#include "ipcclient.h"
+
+IpcClient::IpcClient(QObject *parent)
+    : QObject(parent), m_socket(new QLocalSocket(this)) {
+  connect(m_socket, &QLocalSocket::readyRead, this, &IpcClient::onReadyRead);
+  connect(m_socket, &QLocalSocket::disconnected, this,
+          &IpcClient::disconnected);
+}
+
+bool IpcClient::connectToGuard(const QString &name, int timeoutMs) {
+  m_socket->connectToServer(name);
+  return m_socket->waitForConnected(timeoutMs);
+}
+
+bool IpcClient::isConnected() const {
+  return m_socket->state() == QLocalSocket::ConnectedState;
+}
+
+void IpcClient::requestStatus() { send(IpcProtocol::GetStatus); }
+
+void IpcClient::subscribe() { send(IpcProtocol::Subscribe); }
+
+void IpcClient::unsubscribe() { send(IpcProtocol::Unsubscribe); }
+
+void IpcClient::login() { send(IpcProtocol::Login); }
+
+void IpcClient::logout() { send(IpcProtocol::Logout); }
+
+void IpcClient::send(quint8 type) {
+  m_socket->write(IpcProtocol::encodeFrame(type));
+  m_socket->flush();
+}
+
+void IpcClient::onReadyRead() {
+  m_buffer.append(m_socket->readAll());
+
+  quint8 type;
+  QByteArray payload;
+  while (IpcProtocol::takeFrame(m_buffer, &type, &payload)) {
+    bool ok = false;
+    QString message;
+    switch (type) {
+    case IpcProtocol::Status: {
+      IpcProtocol::StatusSnapshot snapshot;
+      if (IpcProtocol::decodeStatus(payload, &snapshot))
+        emit statusReceived(snapshot);
+      break;
+    }
+    case IpcProtocol::LoginResult:
+      if (IpcProtocol::decodeResult(payload, &ok, &message))
+        emit loginResult(ok, message);
+      break;
+    case IpcProtocol::LogoutResult:
+      if (IpcProtocol::decodeResult(payload, &ok, &message))
+        emit logoutResult(ok, message);
+      break;
+    case IpcProtocol::Error:
+      emit errorReceived(QString::fromUtf8(payload));
+      break;
+    default:
+      break;
+    }
+  }
+}
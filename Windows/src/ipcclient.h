@@ -0,0 +1,43 @@
+#ifndef IPCCLIENT_H
+#define IPCCLIENT_H
+
+#include <QLocalSocket>
+#include <QObject>
+
+#include "ipcprotocol.h"
+
+// 本地控制通道客户端, 供命令行工具和其他前端使用
+class IpcClient : public QObject {
+  Q_OBJECT
+
+public:
+  explicit IpcClient(QObject *parent = nullptr);
+
+  bool connectToGuard(const QString &name = IpcProtocol::serverName(),
+                      int timeoutMs = 1000);
+  bool isConnected() const;
+
+  void requestStatus();
+  void subscribe();
+  void unsubscribe();
+  void login();
+  void logout();
+
+signals:
+  void statusReceived(const IpcProtocol::StatusSnapshot &snapshot);
+  void loginResult(bool ok, const QString &message);
+  void logoutResult(bool ok, const QString &message);
+  void errorReceived(const QString &message);
+  void disconnected();
+
+private slots:
+  void onReadyRead();
+
+private:
+  void send(quint8 type);
+
+  QLocalSocket *m_socket;
+  QByteArray m_buffer;
+};
+
+#endif // IPCCLIENT_H
@@ -0,0 +1,115 @@
+#include "ipcprotocol.h"
+#include <QStandardPaths>
+#include <QtEndian>
+
+#ifndef Q_OS_WIN
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 状态负载: [u8 标志][i64 流量][i64 时长][i64 时间戳][IP utf8]
+const quint8 FLAG_VALID = 0x01;
+const quint8 FLAG_ONLINE = 0x02;
+const int STATUS_FIXED_SIZE = 1 + 8 * 3;
+
+void appendInt64(QByteArray &out, qint64 value) {
+  char buf[8];
+  qToBigEndian<qint64>(value, buf);
+  out.append(buf, 8);
+}
+
+qint64 readInt64(const char *data) { return qFromBigEndian<qint64>(data); }
+
+} // namespace
+
+QString IpcProtocol::serverName() {
+#ifdef Q_OS_WIN
+  return "haut-network-guard-" + qEnvironmentVariable("USERNAME");
+#else
+  if (::geteuid() == 0)
+    return "/run/haut-network-guard/control.sock";
+  // 运行时目录不可用时不回退到公共临时目录, 由 listen 报告失败
+  const QString runtime =
+      QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+  return runtime.isEmpty() ? QString() : runtime + "/haut-network-guard.sock";
+#endif
+}
+
+QByteArray IpcProtocol::encodeFrame(quint8 type, const QByteArray &payload) {
+  const int size = qMin<int>(payload.size(), MAX_PAYLOAD);
+  QByteArray frame;
+  frame.reserve(HEADER_SIZE + size);
+  char header[HEADER_SIZE];
+  qToBigEndian<quint16>(static_cast<quint16>(size), header);
+  header[2] = static_cast<char>(type);
+  frame.append(header, HEADER_SIZE);
+  frame.append(payload.constData(), size);
+  return frame;
+}
+
+bool IpcProtocol::takeFrame(QByteArray &buffer, quint8 *type,
+                            QByteArray *payload) {
+  if (buffer.size() < HEADER_SIZE)
+    return false;
+
+  const int size = qFromBigEndian<quint16>(buffer.constData());
+  if (buffer.size() < HEADER_SIZE + size)
+    return false;
+
+  *type = static_cast<quint8>(buffer.at(2));
+  *payload = buffer.mid(HEADER_SIZE, size);
+  buffer.remove(0, HEADER_SIZE + size);
+  return true;
+}
+
+QByteArray IpcProtocol::encodeStatus(const StatusSnapshot &snapshot) {
+  QByteArray ip = snapshot.ip.toUtf8();
+  QByteArray out;
+  out.reserve(STATUS_FIXED_SIZE + ip.size());
+
+  quint8 flags = 0;
+  if (snapshot.valid)
+    flags |= FLAG_VALID;
+  if (snapshot.online)
+    flags |= FLAG_ONLINE;
+  out.append(static_cast<char>(flags));
+  appendInt64(out, snapshot.bytesUsed);
+  appendInt64(out, snapshot.secondsOnline);
+  appendInt64(out, snapshot.timestamp);
+  out.append(ip);
+  return out;
+}
+
+bool IpcProtocol::decodeStatus(const QByteArray &payload,
+                               StatusSnapshot *snapshot) {
+  if (payload.size() < STATUS_FIXED_SIZE)
+    return false;
+
+  const char *data = payload.constData();
+  quint8 flags = static_cast<quint8>(data[0]);
+  snapshot->valid = flags & FLAG_VALID;
+  snapshot->online = flags & FLAG_ONLINE;
+  snapshot->bytesUsed = readInt64(data + 1);
+  snapshot->secondsOnline = readInt64(data + 9);
+  snapshot->timestamp = readInt64(data + 17);
+  snapshot->ip = QString::fromUtf8(data + STATUS_FIXED_SIZE,
+                                   payload.size() - STATUS_FIXED_SIZE);
+  return true;
+}
+
+QByteArray IpcProtocol::encodeResult(bool ok, const QString &message) {
+  QByteArray out;
+  out.append(static_cast<char>(ok ? 1 : 0));
+  out.append(message.toUtf8());
+  return out;
+}
+
+bool IpcProtocol::decodeResult(const QByteArray &payload, bool *ok,
+                               QString *message) {
+  if (payload.isEmpty())
+    return false;
+  *ok = payload.at(0) != 0;
+  *message = QString::fromUtf8(payload.constData() + 1, payload.size() - 1);
+  return true;
+}
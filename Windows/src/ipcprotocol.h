@@ -0,0 +1,58 @@
+#ifndef IPCPROTOCOL_H
+#define IPCPROTOCOL_H
+
+#include <QByteArray>
+#include <QString>
+
+// 本地控制通道的二进制协议
+// 帧格式: [u16 负载长度 (大端)][u8 消息类型][负载]
+class IpcProtocol {
+public:
+  enum MessageType : quint8 {
+    // 客户端 -> 守护
+    GetStatus = 0x01,
+    Subscribe = 0x02,
+    Unsubscribe = 0x03,
+    Login = 0x04,
+    Logout = 0x05,
+
+    // 守护 -> 客户端
+    Status = 0x81,      // 状态快照 (查询回复或订阅推送)
+    LoginResult = 0x82, // [u8 成功][utf8 消息]
+    LogoutResult = 0x83,
+    Error = 0xFF // [utf8 消息]
+  };
+
+  // 最近一次 statusChecked 结果
+  struct StatusSnapshot {
+    bool valid = false; // 尚未完成过状态检测时为 false
+    bool online = false;
+    QString ip;
+    qint64 bytesUsed = 0;
+    qint64 secondsOnline = 0;
+    qint64 timestamp = 0; // 检测时间 (毫秒时间戳)
+  };
+
+  static constexpr int HEADER_SIZE = 3;
+  static constexpr int MAX_PAYLOAD = 0xFFFF;
+
+  // 默认服务名, 只属于当前用户: Unix 下 root 使用 /run/haut-network-guard,
+  // 普通用户使用 $XDG_RUNTIME_DIR (其他用户无法抢先创建);
+  // Windows 下为带用户名的命名管道
+  static QString serverName();
+
+  static QByteArray encodeFrame(quint8 type,
+                                const QByteArray &payload = QByteArray());
+  // 从缓冲区取出一个完整帧, 不完整时返回 false 并保留缓冲区
+  static bool takeFrame(QByteArray &buffer, quint8 *type, QByteArray *payload);
+
+  static QByteArray encodeStatus(const StatusSnapshot &snapshot);
+  static bool decodeStatus(const QByteArray &payload,
+                           StatusSnapshot *snapshot);
+
+  static QByteArray encodeResult(bool ok, const QString &message);
+  static bool decodeResult(const QByteArray &payload, bool *ok,
+                           QString *message);
+};
+
+#endif // IPCPROTOCOL_H
@@ -0,0 +1,208 @@
+#include "ipcserver.h"
+#include "config.h"
+#include "metrics.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+IpcServer::IpcServer(Api *api, GuardController *controller, QObject *parent)
+    : QObject(parent), m_api(api), m_controller(controller),
+      m_server(new QLocalServer(this)) {
+  connect(m_server, &QLocalServer::newConnection, this,
+          &IpcServer::onNewConnection);
+
+  connect(m_api, &Api::statusChecked, this, &IpcServer::onStatusChecked);
+  connect(m_api, &Api::loginSuccess, this, &IpcServer::onLoginSuccess);
+  connect(m_api, &Api::loginFailed, this, &IpcServer::onLoginFailed);
+  connect(m_api, &Api::logoutSuccess, this, &IpcServer::onLogoutSuccess);
+  connect(m_api, &Api::logoutFailed, this, &IpcServer::onLogoutFailed);
+  connect(m_api, &Api::requestRejected, this, &IpcServer::onRequestRejected);
+  connect(m_controller, &GuardController::refreshStarted, this,
+          [this]() { m_refreshing = true; });
+  connect(m_controller, &GuardController::refreshFinished, this,
+          [this]() { m_refreshing = false; });
+}
+
+IpcServer::~IpcServer() {}
+
+bool IpcServer::listen(const QString &name) {
+  if (name.isEmpty()) {
+    m_error = "没有可用的运行时目录 (XDG_RUNTIME_DIR)";
+    qWarning() << "本地控制通道监听失败:" << m_error;
+    return false;
+  }
+
+  // 能连上说明已有实例在提供服务, 不能抢占它的套接字
+  QLocalSocket probe;
+  probe.connectToServer(name);
+  if (probe.waitForConnected(200)) {
+    m_error = "已被其他实例占用: " + name;
+    qWarning() << "本地控制通道" << m_error;
+    return false;
+  }
+
+  // 套接字路径所在目录 (如 /run/haut-network-guard) 可能尚未创建
+  if (QDir::isAbsolutePath(name))
+    QDir().mkpath(QFileInfo(name).absolutePath());
+  // 清理上次异常退出遗留的套接字文件
+  QLocalServer::removeServer(name);
+  m_server->setSocketOptions(QLocalServer::UserAccessOption);
+  if (!m_server->listen(name)) {
+    m_error = m_server->errorString();
+    qWarning() << "本地控制通道监听失败:" << m_error;
+    return false;
+  }
+  return true;
+}
+
+void IpcServer::onNewConnection() {
+  while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+    Client client;
+    client.socket = socket;
+    m_clients.append(client);
+    connect(socket, &QLocalSocket::readyRead, this, &IpcServer::onReadyRead);
+    connect(socket, &QLocalSocket::disconnected, this,
+            &IpcServer::onDisconnected);
+    Metrics::instance().add("ipc_connections");
+  }
+}
+
+IpcServer::Client *IpcServer::findClient(QLocalSocket *socket) {
+  for (Client &client : m_clients) {
+    if (client.socket == socket)
+      return &client;
+  }
+  return nullptr;
+}
+
+void IpcServer::onReadyRead() {
+  QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+  Client *client = socket ? findClient(socket) : nullptr;
+  if (!client)
+    return;
+
+  client->buffer.append(socket->readAll());
+
+  quint8 type;
+  QByteArray payload;
+  while (IpcProtocol::takeFrame(client->buffer, &type, &payload))
+    handleFrame(*client, type, payload);
+}
+
+void IpcServer::onDisconnected() {
+  QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+  if (!socket)
+    return;
+
+  for (int i = 0; i < m_clients.size(); ++i) {
+    if (m_clients[i].socket == socket) {
+      m_clients.removeAt(i);
+      break;
+    }
+  }
+  socket->deleteLater();
+}
+
+void IpcServer::handleFrame(Client &client, quint8 type,
+                            const QByteArray &payload) {
+  Q_UNUSED(payload);
+  Metrics::instance().add("ipc_requests");
+
+  switch (type) {
+  case IpcProtocol::GetStatus:
+    // 直接返回缓存, 不产生新的门户请求
+    send(client, IpcProtocol::Status, IpcProtocol::encodeStatus(m_snapshot));
+    break;
+  case IpcProtocol::Subscribe:
+    client.subscribed = true;
+    send(client, IpcProtocol::Status, IpcProtocol::encodeStatus(m_snapshot));
+    break;
+  case IpcProtocol::Unsubscribe:
+    client.subscribed = false;
+    break;
+  case IpcProtocol::Login: {
+    const Config &config = Config::instance();
+    if (config.username().isEmpty() || config.password().isEmpty()) {
+      send(client, IpcProtocol::LoginResult,
+           IpcProtocol::encodeResult(false, "未配置用户名或密码"));
+      break;
+    }
+    // 与界面的手动登录相同: 解除自动登录暂停, 结果仍由 Api 信号回复
+    client.awaitingLogin = true;
+    m_controller->manualLogin(config.username(), config.password());
+    break;
+  }
+  case IpcProtocol::Logout:
+    client.awaitingLogout = true;
+    m_controller->manualLogout();
+    break;
+  default:
+    send(client, IpcProtocol::Error,
+         QString("未知消息类型: 0x%1")
+             .arg(static_cast<int>(type), 2, 16, QChar('0'))
+             .toUtf8());
+    break;
+  }
+}
+
+void IpcServer::send(Client &client, quint8 type, const QByteArray &payload) {
+  client.socket->write(IpcProtocol::encodeFrame(type, payload));
+}
+
+void IpcServer::onStatusChecked(bool online, const QString &ip,
+                                qint64 bytesUsed, qint64 secondsOnline) {
+  m_snapshot.valid = true;
+  m_snapshot.online = online;
+  m_snapshot.ip = ip;
+  m_snapshot.bytesUsed = bytesUsed;
+  m_snapshot.secondsOnline = secondsOnline;
+  m_snapshot.timestamp = QDateTime::currentMSecsSinceEpoch();
+
+  // 每个帧只编码一次, 推送给所有订阅者
+  QByteArray frame = IpcProtocol::encodeFrame(
+      IpcProtocol::Status, IpcProtocol::encodeStatus(m_snapshot));
+  for (Client &client : m_clients) {
+    if (client.subscribed)
+      client.socket->write(frame);
+  }
+}
+
+void IpcServer::replyPending(quint8 type, bool ok, const QString &message) {
+  QByteArray frame =
+      IpcProtocol::encodeFrame(type, IpcProtocol::encodeResult(ok, message));
+  bool login = type == IpcProtocol::LoginResult;
+  for (Client &client : m_clients) {
+    bool &pending = login ? client.awaitingLogin : client.awaitingLogout;
+    // 订阅者同样会收到结果通知, 主动刷新会话的注销/重新登录除外
+    if (pending || (client.subscribed && !m_refreshing)) {
+      pending = false;
+      client.socket->write(frame);
+    }
+  }
+}
+
+void IpcServer::onLoginSuccess(const QString &message) {
+  replyPending(IpcProtocol::LoginResult, true, message);
+}
+
+void IpcServer::onLoginFailed(const QString &error) {
+  replyPending(IpcProtocol::LoginResult, false, error);
+}
+
+void IpcServer::onLogoutSuccess() {
+  replyPending(IpcProtocol::LogoutResult, true, "注销成功");
+}
+
+void IpcServer::onLogoutFailed(const QString &error) {
+  replyPending(IpcProtocol::LogoutResult, false, error);
+}
+
+void IpcServer::onRequestRejected(Api::Operation operation,
+                                  const QString &reason) {
+  if (operation == Api::Operation::Login) {
+    replyPending(IpcProtocol::LoginResult, false, reason);
+  } else if (operation == Api::Operation::Logout) {
+    replyPending(IpcProtocol::LogoutResult, false, reason);
+  }
+}
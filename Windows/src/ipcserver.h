@@ -0,0 +1,67 @@
+#ifndef IPCSERVER_H
+#define IPCSERVER_H
+
+#include <QList>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QObject>
+
+#include "api.h"
+#include "guardcontroller.h"
+#include "ipcprotocol.h"
+
+// 本地控制通道: 多个前端 (托盘/命令行/监控) 共享同一个状态轮询
+// 查询直接返回缓存的最近一次状态, 订阅者在每次状态检测后收到推送;
+// 登录/注销交给断线重连状态机, 与自动登录共用同一套在途/暂停状态
+class IpcServer : public QObject {
+  Q_OBJECT
+
+public:
+  IpcServer(Api *api, GuardController *controller, QObject *parent = nullptr);
+  ~IpcServer();
+
+  // 开始监听; 已有其他实例在监听或无法创建套接字时返回 false,
+  // 原因见 errorString()
+  bool listen(const QString &name = IpcProtocol::serverName());
+  QString errorString() const { return m_error; }
+
+  const IpcProtocol::StatusSnapshot &snapshot() const { return m_snapshot; }
+
+private slots:
+  void onNewConnection();
+  void onReadyRead();
+  void onDisconnected();
+  void onStatusChecked(bool online, const QString &ip, qint64 bytesUsed,
+                       qint64 secondsOnline);
+  void onLoginSuccess(const QString &message);
+  void onLoginFailed(const QString &error);
+  void onLogoutSuccess();
+  void onLogoutFailed(const QString &error);
+  void onRequestRejected(Api::Operation operation, const QString &reason);
+
+private:
+  struct Client {
+    QLocalSocket *socket;
+    QByteArray buffer;
+    bool subscribed = false;
+    bool awaitingLogin = false;
+    bool awaitingLogout = false;
+  };
+
+  Client *findClient(QLocalSocket *socket);
+  void handleFrame(Client &client, quint8 type, const QByteArray &payload);
+  void send(Client &client, quint8 type,
+            const QByteArray &payload = QByteArray());
+  // 将登录/注销结果回复给发起请求的客户端
+  void replyPending(quint8 type, bool ok, const QString &message);
+
+  Api *m_api;
+  GuardController *m_controller;
+  QLocalServer *m_server;
+  QList<Client> m_clients;
+  IpcProtocol::StatusSnapshot m_snapshot;
+  QString m_error;
+  bool m_refreshing = false;
+};
+
+#endif // IPCSERVER_H
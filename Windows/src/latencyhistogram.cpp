@@ -0,0 +1,109 @@
+#include "latencyhistogram.h"
+#include <cmath>
+
+void LatencyHistogram::clear() { *this = LatencyHistogram(); }
+
+int LatencyHistogram::bucketFor(qint64 rttUs) {
+  // 桶 0 为 1 ms 以下, 之后每 2^(1/4) 倍一个桶
+  if (rttUs < 1000)
+    return 0;
+  int bucket = 1 + static_cast<int>(std::log2(rttUs / 1000.0) * 4);
+  return qMin(bucket, BUCKETS - 1);
+}
+
+qint64 LatencyHistogram::bucketValueUs(int bucket) {
+  if (bucket == 0)
+    return 500;
+  // 取桶内几何中点
+  return static_cast<qint64>(1000.0 * std::exp2((bucket - 0.5) / 4.0));
+}
+
+void LatencyHistogram::addRtt(qint64 rttUs) {
+  quint16 &count = m_counts[bucketFor(rttUs)];
+  if (count < 0xFFFF && m_received < 0xFFFF) {
+    ++count;
+    ++m_received;
+  }
+}
+
+void LatencyHistogram::addLoss() {
+  if (m_lost < 0xFFFF)
+    ++m_lost;
+}
+
+void LatencyHistogram::addJitter(qint64 deltaUs) {
+  if (m_jitterCount == 0xFFFF)
+    return;
+  ++m_jitterCount;
+  m_jitterSumUs += static_cast<quint64>(qMax<qint64>(deltaUs, 0));
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+  // 合并结果只用于查询, 计数在窗口内不会溢出 16 位
+  for (int i = 0; i < BUCKETS; ++i)
+    m_counts[i] += other.m_counts[i];
+  m_received += other.m_received;
+  m_lost += other.m_lost;
+  m_jitterCount += other.m_jitterCount;
+  m_jitterSumUs += other.m_jitterSumUs;
+}
+
+qint64 LatencyHistogram::percentileUs(double q) const {
+  if (m_received == 0)
+    return -1;
+
+  const int rank = qMax(1, static_cast<int>(std::ceil(q * m_received)));
+  int seen = 0;
+  for (int i = 0; i < BUCKETS; ++i) {
+    seen += m_counts[i];
+    if (seen >= rank)
+      return bucketValueUs(i);
+  }
+  return bucketValueUs(BUCKETS - 1);
+}
+
+qint64 LatencyHistogram::meanJitterUs() const {
+  return m_jitterCount ? m_jitterSumUs / m_jitterCount : -1;
+}
+
+double LatencyHistogram::lossRate() const {
+  const int total = probes();
+  return total ? static_cast<double>(m_lost) / total : 0.0;
+}
+
+LatencyWindow::LatencyWindow(qint64 slotMs, int slotCount)
+    : m_slotMs(slotMs), m_slots(slotCount) {}
+
+LatencyHistogram &LatencyWindow::slotFor(qint64 nowMs) {
+  const qint64 epoch = nowMs / m_slotMs;
+  Slot &slot = m_slots[static_cast<int>(epoch % m_slots.size())];
+  if (slot.epoch != epoch) {
+    slot.epoch = epoch;
+    slot.histogram.clear();
+  }
+  return slot.histogram;
+}
+
+void LatencyWindow::addRtt(qint64 nowMs, qint64 rttUs) {
+  slotFor(nowMs).addRtt(rttUs);
+}
+
+void LatencyWindow::addLoss(qint64 nowMs) { slotFor(nowMs).addLoss(); }
+
+void LatencyWindow::addJitter(qint64 nowMs, qint64 deltaUs) {
+  slotFor(nowMs).addJitter(deltaUs);
+}
+
+LatencyHistogram LatencyWindow::merged(qint64 nowMs) const {
+  const qint64 epoch = nowMs / m_slotMs;
+  LatencyHistogram result;
+  for (const Slot &slot : m_slots) {
+    if (slot.epoch >= 0 && epoch - slot.epoch < m_slots.size())
+      result.merge(slot.histogram);
+  }
+  return result;
+}
+
+int LatencyWindow::memoryBytes() const {
+  return static_cast<int>(sizeof(*this) + m_slots.size() * sizeof(Slot));
+}
@@ -0,0 +1,64 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QVector>
+#include <QtGlobal>
+
+// 固定内存的时延直方图: 对数分桶 (每 2 倍 4 个桶, 1 ms ~ 3 s),
+// 分位数相对误差约 9%, 另记探测/丢失次数与抖动
+class LatencyHistogram {
+public:
+  static constexpr int BUCKETS = 48;
+
+  void clear();
+  void addRtt(qint64 rttUs);
+  void addLoss();
+  void addJitter(qint64 deltaUs);
+  void merge(const LatencyHistogram &other);
+
+  // q 取 0~1, 无样本时返回 -1
+  qint64 percentileUs(double q) const;
+  qint64 meanJitterUs() const;
+  double lossRate() const;
+
+  int samples() const { return m_received; }
+  int probes() const { return m_received + m_lost; }
+
+private:
+  static int bucketFor(qint64 rttUs);
+  static qint64 bucketValueUs(int bucket);
+
+  quint16 m_counts[BUCKETS] = {};
+  quint16 m_received = 0;
+  quint16 m_lost = 0;
+  quint16 m_jitterCount = 0;
+  quint64 m_jitterSumUs = 0;
+};
+
+// 滑动时间窗: 时间分为 slotCount 个槽, 写入时复用过期的槽,
+// 查询时合并仍在窗口内的槽; 构造后不再分配内存
+class LatencyWindow {
+public:
+  LatencyWindow(qint64 slotMs, int slotCount);
+
+  void addRtt(qint64 nowMs, qint64 rttUs);
+  void addLoss(qint64 nowMs);
+  void addJitter(qint64 nowMs, qint64 deltaUs);
+
+  LatencyHistogram merged(qint64 nowMs) const;
+  qint64 spanMs() const { return m_slotMs * m_slots.size(); }
+  int memoryBytes() const;
+
+private:
+  struct Slot {
+    qint64 epoch = -1;
+    LatencyHistogram histogram;
+  };
+
+  LatencyHistogram &slotFor(qint64 nowMs);
+
+  qint64 m_slotMs;
+  QVector<Slot> m_slots;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -1,6 +1,9 @@
 #include "config.h"
 #include "mainwindow.h"
+#include "proxycache.h"
+#include "tracer.h"
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QStyle>
 
 int main(int argc, char *argv[]) {
@@ -13,12 +16,24 @@ int main(int argc, char *argv[]) {
   // 使用系统默认图标
   app.setWindowIcon(app.style()->standardIcon(QStyle::SP_ComputerIcon));
 
+  // --trace <文件>: 记录请求与决策时间线, 退出时导出
+  QCommandLineParser parser;
+  QCommandLineOption traceOption(
+      "trace", "记录请求与决策时间线, 退出时写入 Chrome trace JSON", "file");
+  parser.addOption(traceOption);
+  parser.process(app);
+  if (parser.isSet(traceOption))
+    Tracer::instance().enable(parser.value(traceOption));
+
   // 设置关闭最后窗口时不退出应用（托盘常驻）
   app.setQuitOnLastWindowClosed(false);
 
   // 加载配置
   Config::instance();
 
+  // 非认证流量的系统代理决策按目标缓存
+  CachingProxyFactory::install();
+
   // 创建主窗口
   MainWindow mainWindow;
   mainWindow.show();
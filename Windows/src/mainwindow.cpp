@@ -1,15 +1,22 @@
 #include "mainwindow.h"
 #include "config.h"
+#include "metrics.h"
 #include <QApplication>
+#include <QDateTime>
+#include <QDebug>
 #include <QFormLayout>
 #include <QGroupBox>
 #include <QHBoxLayout>
 #include <QMessageBox>
+#include <QProcess>
 #include <QVBoxLayout>
 
+const int MainWindow::SAMPLE_INTERVAL_VISIBLE_MS = 500;
+const int MainWindow::SAMPLE_INTERVAL_HIDDEN_MS = 5000;
+
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
   setWindowTitle("HAUT Network Guard v1.3.4");
-  setFixedSize(400, 550);
+  setFixedSize(400, 650);
 
   setupUi();
   loadSettings();
@@ -21,6 +28,18 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
   connect(m_api, &Api::logoutSuccess, this, &MainWindow::onLogoutSuccess);
   connect(m_api, &Api::logoutFailed, this, &MainWindow::onLogoutFailed);
   connect(m_api, &Api::statusChecked, this, &MainWindow::onStatusChecked);
+  connect(m_api, &Api::requestRejected, this, &MainWindow::onRequestRejected);
+  // 配置的认证服务器不可达时自动发现新地址 (含上次发现结果的缓存)
+  m_portalDiscovery = new PortalDiscovery(m_api, this);
+  // 上次已知状态: 比发现缓存更新的可用地址优先
+  m_stateSnapshot = new StateSnapshot(m_api, this);
+  if (m_stateSnapshot->load())
+    m_stateSnapshot->restorePortal();
+
+  connect(&PortalThrottle::instance(), &PortalThrottle::stateChanged, this,
+          &MainWindow::updateThrottleDisplay);
+  connect(&PortalThrottle::instance(), &PortalThrottle::rejected, this,
+          &MainWindow::updateThrottleDisplay);
 
   // 初始化托盘图标
   m_trayIcon = new TrayIcon(this);
@@ -32,20 +51,93 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
           &MainWindow::onLoginClicked);
   connect(m_trayIcon, &TrayIcon::logoutRequested, this,
           &MainWindow::onLogoutClicked);
+  connect(m_trayIcon, &TrayIcon::updateRequested, this, [this]() {
+    m_manualUpdateCheck = true;
+    checkForUpdate();
+  });
   m_trayIcon->show();
 
-  // 状态检测定时器 (使用配置的间隔)
-  m_statusTimer = new QTimer(this);
-  connect(m_statusTimer, &QTimer::timeout, this,
-          &MainWindow::checkNetworkStatus);
-  int interval = Config::instance().checkInterval() * 1000;
-  m_statusTimer->start(interval);
-
-  // 启动时检测状态并尝试自动登录
-  QTimer::singleShot(1000, this, &MainWindow::checkNetworkStatus);
-
-  // 启动时延迟自动登录 (等待网络就绪)
-  QTimer::singleShot(3000, this, &MainWindow::tryAutoLogin);
+  // 本地网卡实时速率, 并与门户流量对账
+  m_throughputSampler = new ThroughputSampler(this);
+  connect(m_throughputSampler, &ThroughputSampler::ratesUpdated, this,
+          &MainWindow::onRatesUpdated);
+  connect(m_throughputSampler, &ThroughputSampler::driftMeasured, this,
+          &MainWindow::onDriftMeasured);
+  // 窗口显示后才切换到亚秒级采样, 见 updateSamplerRate()
+  updateSamplerRate();
+
+  // 可选的网络质量监测
+  m_qualityMonitor = new QualityMonitor(this);
+  connect(m_qualityMonitor, &QualityMonitor::updated, this,
+          &MainWindow::updateQualityDisplay);
+  applyQualitySettings();
+
+  // 断线重连状态机: 定时检测状态, 掉线自动登录, 失败按错误策略重试
+  m_clock = new SystemClock(this);
+  m_controller =
+      new GuardController(m_clock, new ApiTransport(m_api, this), this);
+  connect(m_controller, &GuardController::firstOnline, this,
+          &MainWindow::onFirstOnline);
+  // 主动刷新会话期间的注销/重新登录不提示, 也不显示为离线
+  connect(m_controller, &GuardController::refreshStarted, this,
+          [this]() { m_sessionRefreshing = true; });
+  connect(m_controller, &GuardController::refreshFinished, this,
+          [this]() { m_sessionRefreshing = false; });
+  m_stateSnapshot->setController(m_controller);
+  applyControllerSettings();
+  // 主动刷新会话会短暂断网, 尽量选在本机低流量时刻
+  m_controller->setQuietCheck(
+      [this]() { return m_throughputSampler->isQuiet(); });
+  m_controller->start();
+  // 有快照时立即显示并检测一次状态确认, 不必等待启动就绪检测
+  if (m_stateSnapshot->isStale()) {
+    showSnapshot();
+    m_controller->warmStart();
+  }
+  connect(m_portalDiscovery, &PortalDiscovery::discovered, m_controller,
+          &GuardController::checkNow);
+
+  // 本地控制通道: 命令行/监控等前端共享本窗口的状态轮询
+  m_ipcServer = new IpcServer(m_api, m_controller, this);
+  if (!m_ipcServer->listen())
+    m_trayIcon->showMessage("本地控制通道不可用",
+                            m_ipcServer->errorString() +
+                                "\n命令行工具将无法连接本程序",
+                            QSystemTrayIcon::Warning);
+
+  // 休眠唤醒/网络恢复时立即检测; 显示器关闭或电池供电时减少唤醒
+  m_powerMonitor = new PowerMonitor(this);
+  m_powerMonitor->registerWindow(winId());
+  m_controller->setLowPowerCheck(
+      [this]() { return m_powerMonitor->lowPower(); });
+  connect(m_powerMonitor, &PowerMonitor::resumed, m_controller,
+          &GuardController::wake);
+  connect(m_powerMonitor, &PowerMonitor::networkUp, m_controller,
+          &GuardController::wake);
+  connect(m_powerMonitor, &PowerMonitor::lowPowerChanged, this,
+          &MainWindow::onLowPowerChanged);
+
+  // 增量更新: 只下载补丁, 校验后整体替换; 先清理上次替换下来的旧文件
+  m_updater = new Updater(this);
+  Updater::cleanup(m_updater->installDir());
+  connect(m_updater, &Updater::updateAvailable, this,
+          &MainWindow::onUpdateAvailable);
+  connect(m_updater, &Updater::readyToApply, this, &MainWindow::onUpdateReady);
+  connect(m_updater, &Updater::failed, this, &MainWindow::onUpdateFailed);
+  connect(m_trayIcon, &TrayIcon::messageClicked, this,
+          &MainWindow::promptUpdate);
+  connect(m_updater, &Updater::upToDate, this, [this]() {
+    if (m_manualUpdateCheck)
+      m_trayIcon->showMessage("检查更新", "已是最新版本");
+  });
+
+  // 启动时等待网络真正就绪后再检测状态并自动登录
+  m_bootSequence = new BootSequence(m_api->portalUrl(), this);
+  connect(m_bootSequence, &BootSequence::ready, this,
+          &MainWindow::onBootReady);
+  connect(m_bootSequence, &BootSequence::timedOut, this,
+          &MainWindow::onBootTimedOut);
+  m_bootSequence->start();
 }
 
 MainWindow::~MainWindow() {}
@@ -72,15 +164,29 @@ void MainWindow::setupUi() {
   m_statusLabel = new QLabel("检测中...");
   m_statusLabel->setAlignment(Qt::AlignCenter);
   m_statusLabel->setStyleSheet("font-size: 18px; font-weight: bold;");
-  statusLayout->addWidget(m_statusLabel);
+
+  // 在线状态旁显示网络质量评级, 悬停查看详细统计
+  m_qualityLabel = new QLabel();
+  m_qualityLabel->setVisible(false);
+  QHBoxLayout *stateLayout = new QHBoxLayout();
+  stateLayout->addStretch();
+  stateLayout->addWidget(m_statusLabel);
+  stateLayout->addWidget(m_qualityLabel);
+  stateLayout->addStretch();
+  statusLayout->addLayout(stateLayout);
 
   QFormLayout *infoLayout = new QFormLayout();
   m_ipLabel = new QLabel("-");
   m_usageLabel = new QLabel("-");
   m_timeLabel = new QLabel("-");
+  m_throttleLabel = new QLabel(PortalThrottle::stateText(
+      PortalThrottle::State::Closed));
   infoLayout->addRow("IP 地址:", m_ipLabel);
   infoLayout->addRow("已用流量:", m_usageLabel);
   infoLayout->addRow("在线时长:", m_timeLabel);
+  m_rateLabel = new QLabel("-");
+  infoLayout->addRow("实时速率:", m_rateLabel);
+  infoLayout->addRow("服务保护:", m_throttleLabel);
   statusLayout->addLayout(infoLayout);
 
   mainLayout->addWidget(statusGroup);
@@ -105,6 +211,15 @@ void MainWindow::setupUi() {
   accountLayout->addRow(m_autoLaunchCheck);
   accountLayout->addRow(m_autoLoginCheck);
 
+  m_directRouteCheck = new QCheckBox("认证直连 (不使用系统代理)");
+  m_directRouteCheck->setToolTip("认证请求跳过代理自动发现, 加快断线后的登录");
+  accountLayout->addRow(m_directRouteCheck);
+
+  m_qualityMonitorCheck = new QCheckBox("网络质量监测");
+  m_qualityMonitorCheck->setToolTip(
+      "定期 TCP 探测认证服务器, 统计时延、抖动与丢失率");
+  accountLayout->addRow(m_qualityMonitorCheck);
+
   // 检测间隔设置
   QHBoxLayout *intervalLayout = new QHBoxLayout();
   m_intervalSpinBox = new QSpinBox();
@@ -155,6 +270,8 @@ void MainWindow::loadSettings() {
   m_autoSaveCheck->setChecked(config.autoSave());
   m_autoLaunchCheck->setChecked(config.autoLaunch());
   m_autoLoginCheck->setChecked(config.autoLogin());
+  m_directRouteCheck->setChecked(config.directRoute());
+  m_qualityMonitorCheck->setChecked(config.qualityMonitor());
   m_intervalSpinBox->setValue(config.checkInterval());
 }
 
@@ -167,12 +284,22 @@ void MainWindow::saveSettings() {
   config.setAutoSave(m_autoSaveCheck->isChecked());
   config.setAutoLaunch(m_autoLaunchCheck->isChecked());
   config.setAutoLogin(m_autoLoginCheck->isChecked());
+  config.setDirectRoute(m_directRouteCheck->isChecked());
+  config.setQualityMonitor(m_qualityMonitorCheck->isChecked());
   config.setCheckInterval(m_intervalSpinBox->value());
   config.setHasConfigured(true);
   config.save();
 
-  // 更新定时器间隔
-  m_statusTimer->setInterval(config.checkInterval() * 1000);
+  m_api->setDirectRoute(config.directRoute());
+  applyControllerSettings();
+  applyQualitySettings();
+}
+
+void MainWindow::applyControllerSettings() {
+  Config &config = Config::instance();
+  m_controller->setCredentials(config.username(), config.password());
+  m_controller->setAutoLogin(config.autoLogin());
+  m_controller->setCheckInterval(config.checkInterval() * 1000);
 }
 
 void MainWindow::onLoginClicked() {
@@ -187,38 +314,59 @@ void MainWindow::onLoginClicked() {
   m_loginBtn->setEnabled(false);
   m_loginBtn->setText("登录中...");
 
-  m_api->login(username, password);
+  // 手动登录解除因错误码暂停的自动登录
+  m_controller->manualLogin(username, password);
 }
 
 void MainWindow::onLogoutClicked() {
   m_logoutBtn->setEnabled(false);
   m_logoutBtn->setText("注销中...");
 
-  m_api->logout();
+  m_controller->manualLogout();
 }
 
 void MainWindow::onSaveClicked() {
   saveSettings();
+  m_controller->resume();
   QMessageBox::information(this, "提示", "设置已保存");
 }
 
 void MainWindow::onLoginSuccess(const QString &message) {
+  if (m_sessionRefreshing)
+    return;
   m_loginBtn->setEnabled(true);
   m_loginBtn->setText("登录");
 
   m_trayIcon->showMessage("登录成功", message);
-  checkNetworkStatus();
 }
 
-void MainWindow::onLoginFailed(const QString &error) {
+void MainWindow::onLoginFailed(const QString &error, PortalError::Code code,
+                               PortalError::Policy policy) {
+  Q_UNUSED(code);
+  bool manual = !m_loginBtn->isEnabled();
   m_loginBtn->setEnabled(true);
   m_loginBtn->setText("登录");
 
+  if (policy == PortalError::Policy::Stop) {
+    // 密码错误/欠费等重试无效的错误: 状态机已暂停自动登录, 提醒用户.
+    // 后台自动登录只发托盘通知, 不弹出无人等待的对话框
+    m_trayIcon->showMessage("登录失败", error + "\n已暂停自动登录",
+                            QSystemTrayIcon::Critical);
+    if (manual)
+      QMessageBox::warning(
+          this, "登录失败",
+          error + "\n\n自动登录已暂停, 请检查账号后手动登录。");
+    return;
+  }
+
   m_trayIcon->showMessage("登录失败", error, QSystemTrayIcon::Warning);
-  QMessageBox::warning(this, "登录失败", error);
+  if (manual)
+    QMessageBox::warning(this, "登录失败", error);
 }
 
 void MainWindow::onLogoutSuccess() {
+  if (m_sessionRefreshing)
+    return;
   m_logoutBtn->setEnabled(true);
   m_logoutBtn->setText("注销");
 
@@ -235,44 +383,242 @@ void MainWindow::onLogoutFailed(const QString &error) {
 
 void MainWindow::onStatusChecked(bool online, const QString &ip,
                                  qint64 bytesUsed, qint64 secondsOnline) {
-  bool wasOnline = m_isOnline;
-  m_isOnline = online;
-
   updateStatusDisplay(online, ip, bytesUsed, secondsOnline);
   m_trayIcon->setOnlineStatus(online);
+  m_throughputSampler->reconcile(online, bytesUsed);
+
+  // 学到的会话寿命与主动刷新效果
+  const qint64 lifetime = m_controller->sessionModel().predictedLifetimeMs();
+  const GuardController::Stats &stats = m_controller->stats();
+  m_timeLabel->setToolTip(
+      lifetime < 0 ? QString("尚未学到会话时长")
+                   : QString("会话时长约 %1, 到期前已主动刷新 %2 次, "
+                             "避免掉线 %3 次")
+                         .arg(formatTime(lifetime / 1000))
+                         .arg(stats.refreshes)
+                         .arg(stats.outagesAvoided));
+}
 
-  // 如果离线且开启了自动登录，则自动重连
-  if (!online && Config::instance().autoLogin()) {
-    QString username = Config::instance().username();
-    QString password = Config::instance().password();
+void MainWindow::onFirstOnline(qint64 elapsedMs) {
+  Metrics::instance().set("boot_to_online_ms", elapsedMs);
+  qInfo() << "启动到在线用时" << elapsedMs << "ms";
 
-    if (!username.isEmpty() && !password.isEmpty()) {
-      // 只有从在线变为离线，或启动时检测才自动登录
-      if (wasOnline || !m_startupLoginAttempted) {
-        m_api->login(username, password);
-      }
-    }
+  // 清单只有几百字节, 上线后检查一次
+  if (Config::instance().updateCheck()) {
+    m_manualUpdateCheck = false;
+    checkForUpdate();
+  }
+}
+
+void MainWindow::checkForUpdate() {
+  if (!m_updater->isBusy())
+    m_updater->check(QUrl(Config::instance().updateUrl()));
+}
+
+void MainWindow::onUpdateAvailable(const QString &version,
+                                   const QString &notes, qint64 downloadBytes,
+                                   qint64 fullBytes) {
+  QString text = QString("发现新版本 v%1\n\n需下载 %2 (完整安装包 %3)")
+                     .arg(version, formatBytes(downloadBytes),
+                          formatBytes(fullBytes));
+  if (!notes.isEmpty())
+    text += "\n\n" + notes;
+  m_updatePrompt = text;
+
+  // 自动检查在开机后台运行, 只发通知, 用户点击后才弹出询问
+  if (m_manualUpdateCheck)
+    promptUpdate();
+  else
+    m_trayIcon->showActionMessage(
+        "检查更新", QString("发现新版本 v%1, 点击查看").arg(version));
+}
+
+void MainWindow::promptUpdate() {
+  if (m_updatePrompt.isEmpty() || m_updater->isBusy())
+    return;
+  const QString text = m_updatePrompt;
+  m_updatePrompt.clear();
+  if (QMessageBox::question(this, "检查更新", text + "\n\n是否立即下载?") ==
+      QMessageBox::Yes)
+    m_updater->download();
+}
+
+void MainWindow::onUpdateReady(qint64 downloadedBytes, qint64 fullBytes) {
+  QString text = QString("更新 v%1 已下载并校验, 实际下载 %2, 节省 %3")
+                     .arg(m_updater->version(), formatBytes(downloadedBytes),
+                          formatBytes(qMax<qint64>(0, fullBytes -
+                                                          downloadedBytes)));
+  if (QMessageBox::question(this, "安装更新",
+                            text + "\n\n是否立即安装并重启程序?") !=
+      QMessageBox::Yes)
+    return;
+
+  QString error;
+  if (!m_updater->apply(&error)) {
+    QMessageBox::warning(this, "安装更新", error + "\n\n已保留当前版本。");
+    return;
+  }
+  QProcess::startDetached(QApplication::applicationFilePath(),
+                          QApplication::arguments().mid(1));
+  exitApplication();
+}
+
+void MainWindow::onUpdateFailed(const QString &error) {
+  // 自动检查失败 (如尚未完全联网) 不打扰用户
+  if (m_manualUpdateCheck)
+    m_trayIcon->showMessage("检查更新", error, QSystemTrayIcon::Warning);
+}
+
+void MainWindow::onBootReady(qint64 elapsedMs) {
+  Metrics::instance().set("boot_ready_ms", elapsedMs);
+  m_controller->bootFinished();
+}
+
+void MainWindow::onBootTimedOut(qint64 elapsedMs) {
+  // 超时仍按原流程检测并尝试登录, 后续由定时器兜底
+  Metrics::instance().set("boot_timeout_ms", elapsedMs);
+  m_portalDiscovery->discover();
+  m_controller->bootFinished();
+}
+
+void MainWindow::onRequestRejected(Api::Operation operation,
+                                   const QString &reason) {
+  // 手动操作被拦截时恢复按钮并提示原因
+  if (operation == Api::Operation::Login && !m_loginBtn->isEnabled()) {
+    m_loginBtn->setEnabled(true);
+    m_loginBtn->setText("登录");
+    m_trayIcon->showMessage("登录暂缓", reason, QSystemTrayIcon::Warning);
+  } else if (operation == Api::Operation::Logout &&
+             !m_logoutBtn->isEnabled()) {
+    m_logoutBtn->setEnabled(true);
+    m_logoutBtn->setText("注销");
+    m_trayIcon->showMessage("注销暂缓", reason, QSystemTrayIcon::Warning);
   }
 }
 
-void MainWindow::tryAutoLogin() {
-  // 启动时尝试自动登录
-  if (m_startupLoginAttempted)
+void MainWindow::updateThrottleDisplay() {
+  const PortalThrottle &throttle = PortalThrottle::instance();
+  PortalThrottle::State state = throttle.state();
+  QString text = PortalThrottle::stateText(state);
+  if (throttle.rejectedCount() > 0)
+    text += QString(" (已拦截 %1 次)").arg(throttle.rejectedCount());
+  m_throttleLabel->setText(text);
+  m_throttleLabel->setStyleSheet(
+      state == PortalThrottle::State::Closed ? "" : "color: #FF9800;");
+}
+
+void MainWindow::onLowPowerChanged(bool lowPower) {
+  Q_UNUSED(lowPower);
+  updateSamplerRate();
+  m_controller->powerStateChanged();
+}
+
+void MainWindow::updateSamplerRate() {
+  // 实时速率只在窗口可见时需要亚秒级刷新; 隐藏到托盘或低功耗时低频采样,
+  // 仍为刷新时机判断与流量对账提供数据
+  const bool watched = isVisible() && !isMinimized() &&
+                       !(m_powerMonitor && m_powerMonitor->lowPower());
+  const int interval =
+      watched ? SAMPLE_INTERVAL_VISIBLE_MS : SAMPLE_INTERVAL_HIDDEN_MS;
+  if (interval == m_samplerIntervalMs)
+    return;
+  m_samplerIntervalMs = interval;
+  m_throughputSampler->start(m_api->portalUrl().host(), interval);
+}
+
+void MainWindow::onRatesUpdated(double downRate, double upRate) {
+  m_rateLabel->setText(
+      QString("↓ %1  ↑ %2").arg(formatRate(downRate), formatRate(upRate)));
+  m_trayIcon->setThroughput(downRate, upRate);
+}
+
+void MainWindow::onDriftMeasured(qint64 localBytes, qint64 portalBytes) {
+  // 本地计数器包含所有经该网卡的流量, 门户只统计计费流量
+  QString tip = QString("最近一次检测间隔内: 本机网卡 %1, 门户计费 %2")
+                    .arg(formatBytes(localBytes), formatBytes(portalBytes));
+  m_usageLabel->setToolTip(tip);
+  if (portalBytes > localBytes + 1024 * 1024)
+    qWarning() << "门户计费流量高于本机计数:" << portalBytes << ">"
+               << localBytes;
+}
+
+void MainWindow::applyQualitySettings() {
+  const Config &config = Config::instance();
+  m_qualityMonitor->stop();
+  if (!config.qualityMonitor()) {
+    m_qualityLabel->setVisible(false);
     return;
-  m_startupLoginAttempted = true;
+  }
 
-  if (!m_isOnline && Config::instance().autoLogin()) {
-    QString username = Config::instance().username();
-    QString password = Config::instance().password();
+  // 第一个目标固定为认证服务器, 评级以它为准
+  QStringList targets;
+  const QUrl portal = m_api->portalUrl();
+  targets << QString("%1:%2").arg(portal.host()).arg(portal.port(80));
+  targets << config.qualityTargets();
+  m_qualityMonitor->setTargets(targets);
+  m_qualityMonitor->start();
+  m_qualityLabel->setVisible(true);
+  updateQualityDisplay();
+}
 
-    if (!username.isEmpty() && !password.isEmpty()) {
-      m_api->login(username, password);
+void MainWindow::updateQualityDisplay() {
+  QualityMonitor::Grade grade = m_qualityMonitor->grade();
+  const char *color = "#9E9E9E";
+  if (grade == QualityMonitor::Grade::Good)
+    color = "#4CAF50";
+  else if (grade == QualityMonitor::Grade::Fair)
+    color = "#FF9800";
+  else if (grade == QualityMonitor::Grade::Poor)
+    color = "#f44336";
+  m_qualityLabel->setText("● " + QualityMonitor::gradeText(grade));
+  m_qualityLabel->setStyleSheet(QString("color: %1;").arg(color));
+
+  auto ms = [](qint64 us) {
+    return us < 0 ? QString("-") : QString::number(us / 1000.0, 'f', 1);
+  };
+  QStringList lines;
+  const QStringList targets = m_qualityMonitor->targets();
+  for (int i = 0; i < targets.size(); ++i) {
+    lines << targets.at(i);
+    for (QualityMonitor::Window window :
+         {QualityMonitor::Window::Minute, QualityMonitor::Window::Hour}) {
+      QualityMonitor::Summary s = m_qualityMonitor->summary(i, window);
+      lines << QString("  %1: p50 %2 / p95 %3 / p99 %4 ms, 抖动 %5 ms, "
+                       "丢失 %6%")
+                   .arg(window == QualityMonitor::Window::Minute ? "1 分钟"
+                                                                 : "1 小时")
+                   .arg(ms(s.p50Us), ms(s.p95Us), ms(s.p99Us),
+                        ms(s.jitterUs))
+                   .arg(s.loss * 100, 0, 'f', 1);
     }
   }
+  m_qualityLabel->setToolTip(lines.join('\n'));
+}
+
+void MainWindow::showSnapshot() {
+  const StateSnapshot::State &state = m_stateSnapshot->state();
+  const IpcProtocol::StatusSnapshot &status = state.status;
+  updateStatusDisplay(status.online, status.ip, status.bytesUsed,
+                      status.secondsOnline);
+  m_trayIcon->setOnlineStatus(status.online);
+
+  // 上次记录仅供参考, 灰色显示直到首次检测结果到达
+  m_statusLabel->setText(m_statusLabel->text() + " (上次记录)");
+  m_statusLabel->setStyleSheet(
+      "font-size: 18px; font-weight: bold; color: #888;");
+  QString tip = "记录于 " + QDateTime::fromMSecsSinceEpoch(status.timestamp)
+                                .toString("MM-dd HH:mm:ss");
+  if (state.loginTimestamp > 0)
+    tip += QString("\n上次登录 %1 (%2)")
+               .arg(QDateTime::fromMSecsSinceEpoch(state.loginTimestamp)
+                        .toString("MM-dd HH:mm:ss"),
+                    state.username);
+  m_statusLabel->setToolTip(tip);
 }
 
 void MainWindow::updateStatusDisplay(bool online, const QString &ip,
                                      qint64 bytes, qint64 seconds) {
+  m_statusLabel->setToolTip(QString());
   if (online) {
     m_statusLabel->setText("🟢 在线");
     m_statusLabel->setStyleSheet(
@@ -290,8 +636,6 @@ void MainWindow::updateStatusDisplay(bool online, const QString &ip,
   }
 }
 
-void MainWindow::checkNetworkStatus() { m_api->checkStatus(); }
-
 void MainWindow::showWindow() {
   show();
   raise();
@@ -310,6 +654,22 @@ void MainWindow::closeEvent(QCloseEvent *event) {
   m_trayIcon->showMessage("HAUT Network Guard", "程序已最小化到系统托盘");
 }
 
+void MainWindow::showEvent(QShowEvent *event) {
+  QMainWindow::showEvent(event);
+  updateSamplerRate();
+}
+
+void MainWindow::hideEvent(QHideEvent *event) {
+  QMainWindow::hideEvent(event);
+  updateSamplerRate();
+}
+
+void MainWindow::changeEvent(QEvent *event) {
+  QMainWindow::changeEvent(event);
+  if (event->type() == QEvent::WindowStateChange)
+    updateSamplerRate();
+}
+
 QString MainWindow::formatBytes(qint64 bytes) {
   if (bytes < 1024)
     return QString("%1 B").arg(bytes);
@@ -320,6 +680,10 @@ QString MainWindow::formatBytes(qint64 bytes) {
   return QString("%1 GB").arg(bytes / (1024.0 * 1024 * 1024), 0, 'f', 2);
 }
 
+QString MainWindow::formatRate(double bytesPerSecond) {
+  return formatBytes(static_cast<qint64>(bytesPerSecond)) + "/s";
+}
+
 QString MainWindow::formatTime(qint64 seconds) {
   qint64 hours = seconds / 3600;
   qint64 minutes = (seconds % 3600) / 60;
@@ -8,10 +8,19 @@
 #include <QMainWindow>
 #include <QPushButton>
 #include <QSpinBox>
-#include <QTimer>
 
 #include "api.h"
+#include "bootsequence.h"
+#include "guardclock.h"
+#include "guardcontroller.h"
+#include "ipcserver.h"
+#include "portaldiscovery.h"
+#include "powermonitor.h"
+#include "qualitymonitor.h"
+#include "statesnapshot.h"
+#include "throughputsampler.h"
 #include "trayicon.h"
+#include "updater.h"
 
 class MainWindow : public QMainWindow {
   Q_OBJECT
@@ -22,6 +31,9 @@ public:
 
 protected:
   void closeEvent(QCloseEvent *event) override;
+  void showEvent(QShowEvent *event) override;
+  void hideEvent(QHideEvent *event) override;
+  void changeEvent(QEvent *event) override;
 
 private slots:
   void onLoginClicked();
@@ -29,25 +41,44 @@ private slots:
   void onSaveClicked();
 
   void onLoginSuccess(const QString &message);
-  void onLoginFailed(const QString &error);
+  void onLoginFailed(const QString &error, PortalError::Code code,
+                     PortalError::Policy policy);
   void onLogoutSuccess();
   void onLogoutFailed(const QString &error);
   void onStatusChecked(bool online, const QString &ip, qint64 bytesUsed,
                        qint64 secondsOnline);
 
-  void checkNetworkStatus();
   void showWindow();
   void exitApplication();
-  void tryAutoLogin();
+  void onBootReady(qint64 elapsedMs);
+  void onBootTimedOut(qint64 elapsedMs);
+  void onFirstOnline(qint64 elapsedMs);
+  void onRequestRejected(Api::Operation operation, const QString &reason);
+  void updateThrottleDisplay();
+  void onRatesUpdated(double downRate, double upRate);
+  void onLowPowerChanged(bool lowPower);
+  void onDriftMeasured(qint64 localBytes, qint64 portalBytes);
+  void updateQualityDisplay();
+  void checkForUpdate();
+  void onUpdateAvailable(const QString &version, const QString &notes,
+                         qint64 downloadBytes, qint64 fullBytes);
+  void promptUpdate();
+  void onUpdateReady(qint64 downloadedBytes, qint64 fullBytes);
+  void onUpdateFailed(const QString &error);
 
 private:
   void setupUi();
   void loadSettings();
   void saveSettings();
+  void applyControllerSettings();
+  void applyQualitySettings();
+  void showSnapshot();
+  void updateSamplerRate();
   void updateStatusDisplay(bool online, const QString &ip = "",
                            qint64 bytes = 0, qint64 seconds = 0);
   QString formatBytes(qint64 bytes);
   QString formatTime(qint64 seconds);
+  QString formatRate(double bytesPerSecond);
 
   // UI 组件
   QWidget *m_centralWidget;
@@ -55,11 +86,16 @@ private:
   QLabel *m_ipLabel;
   QLabel *m_usageLabel;
   QLabel *m_timeLabel;
+  QLabel *m_throttleLabel;
+  QLabel *m_rateLabel;
+  QLabel *m_qualityLabel;
   QLineEdit *m_usernameEdit;
   QLineEdit *m_passwordEdit;
   QCheckBox *m_autoSaveCheck;
   QCheckBox *m_autoLaunchCheck;
   QCheckBox *m_autoLoginCheck;
+  QCheckBox *m_directRouteCheck;
+  QCheckBox *m_qualityMonitorCheck;
   QSpinBox *m_intervalSpinBox;
   QPushButton *m_loginBtn;
   QPushButton *m_logoutBtn;
@@ -68,10 +104,23 @@ private:
   // 功能组件
   Api *m_api;
   TrayIcon *m_trayIcon;
-  QTimer *m_statusTimer;
+  SystemClock *m_clock;
+  GuardController *m_controller;
+  BootSequence *m_bootSequence;
+  IpcServer *m_ipcServer;
+  PortalDiscovery *m_portalDiscovery;
+  StateSnapshot *m_stateSnapshot;
+  ThroughputSampler *m_throughputSampler;
+  int m_samplerIntervalMs = 0;
+  PowerMonitor *m_powerMonitor = nullptr;
+  QualityMonitor *m_qualityMonitor;
+  Updater *m_updater;
+  bool m_manualUpdateCheck = false;
+  QString m_updatePrompt; // 自动检查发现的新版本, 等用户点击通知后询问
+  bool m_sessionRefreshing = false;
 
-  bool m_isOnline = false;
-  bool m_startupLoginAttempted = false;
+  static const int SAMPLE_INTERVAL_VISIBLE_MS;
+  static const int SAMPLE_INTERVAL_HIDDEN_MS;
 };
 
 #endif // MAINWINDOW_H
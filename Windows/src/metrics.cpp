@@ -0,0 +1,27 @@
+#include "metrics.h"
+#include <QMutexLocker>
+
+Metrics &Metrics::instance() {
+  static Metrics instance;
+  return instance;
+}
+
+void Metrics::set(const QString &name, qint64 value) {
+  QMutexLocker locker(&m_mutex);
+  m_values[name] = value;
+}
+
+void Metrics::add(const QString &name, qint64 delta) {
+  QMutexLocker locker(&m_mutex);
+  m_values[name] += delta;
+}
+
+qint64 Metrics::value(const QString &name) const {
+  QMutexLocker locker(&m_mutex);
+  return m_values.value(name, 0);
+}
+
+QMap<QString, qint64> Metrics::snapshot() const {
+  QMutexLocker locker(&m_mutex);
+  return m_values;
+}
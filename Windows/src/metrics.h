@@ -0,0 +1,30 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+// 进程内运行指标 (计数器/耗时), 供日志和界面展示
+class Metrics {
+public:
+  static Metrics &instance();
+
+  // 设置指标值
+  void set(const QString &name, qint64 value);
+
+  // 累加指标值
+  void add(const QString &name, qint64 delta = 1);
+
+  qint64 value(const QString &name) const;
+  QMap<QString, qint64> snapshot() const;
+
+private:
+  Metrics() = default;
+  ~Metrics() = default;
+
+  mutable QMutex m_mutex;
+  QMap<QString, qint64> m_values;
+};
+
+#endif // METRICS_H
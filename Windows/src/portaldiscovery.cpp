@@ -0,0 +1,410 @@
+#include "portaldiscovery.h"
+#include "metrics.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkInterface>
+#include <QNetworkProxy>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#ifdef Q_OS_WIN
+#include <winsock2.h>
+#include <iphlpapi.h>
+#endif
+
+const int PortalDiscovery::PROBE_PORTS[2] = {80, 69};
+const int PortalDiscovery::FAILURE_THRESHOLD = 3;
+const int PortalDiscovery::DEADLINE_MS = 6000;
+const int PortalDiscovery::MIN_INTERVAL_MS = 60 * 1000;
+
+PortalDiscovery::PortalDiscovery(Api *api, QObject *parent)
+    : QObject(parent), m_api(api),
+      m_networkManager(new QNetworkAccessManager(this)),
+      m_deadlineTimer(new QTimer(this)) {
+  // 探测只发往内网地址, 不经过系统代理
+  m_networkManager->setProxy(QNetworkProxy(QNetworkProxy::NoProxy));
+
+  m_deadlineTimer->setSingleShot(true);
+  connect(m_deadlineTimer, &QTimer::timeout, this,
+          &PortalDiscovery::onDeadline);
+  connect(m_api, &Api::portalReachability, this,
+          &PortalDiscovery::onReachability);
+
+  m_gateway = defaultGateways().value(0);
+  applyCache();
+}
+
+PortalDiscovery::~PortalDiscovery() { abortAll(); }
+
+bool PortalDiscovery::applyCache() {
+  QFile file(cachePath());
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QJsonObject cache = QJsonDocument::fromJson(file.readAll()).object();
+  QString host = cache.value("host").toString();
+  int port = cache.value("port").toInt(80);
+  // 缓存只对发现时使用的门户配置有效
+  if (host.isEmpty() ||
+      cache.value("profile").toString() != m_api->profile().name())
+    return false;
+
+  m_api->setPortal(host, port);
+  qInfo() << "使用缓存的认证服务器地址:" << host << "端口" << port;
+  return true;
+}
+
+void PortalDiscovery::onReachability(bool reachable) {
+  if (reachable) {
+    m_failures = 0;
+    return;
+  }
+  ++m_failures;
+
+  QString gateway = defaultGateways().value(0);
+  bool gatewayChanged = !gateway.isEmpty() && gateway != m_gateway;
+  m_gateway = gateway;
+  if (m_running)
+    return;
+
+  // 网关变化立即重新发现; 否则连续失败后发现, 且限制频率
+  bool throttled =
+      m_lastRun.isValid() && m_lastRun.elapsed() < MIN_INTERVAL_MS;
+  if (gatewayChanged || (m_failures >= FAILURE_THRESHOLD && !throttled))
+    discover();
+}
+
+void PortalDiscovery::discover() {
+  if (m_running)
+    return;
+  m_running = true;
+  m_clock.start();
+  m_lastRun.start();
+  m_probed.clear();
+  Metrics::instance().add("portal_discovery_count");
+
+  // 当前地址也参与竞争, 以免瞬时故障导致切换到更慢的节点
+  addCandidate(m_api->profile().statusUrl().host());
+  for (const QString &host : m_api->profile().candidates())
+    addCandidate(host);
+  // 网关与 DHCP 服务器由所在网络决定, 与重定向目标一样需在本地网段内
+  const QStringList local = defaultGateways() + dhcpServers();
+  for (const QString &host : local) {
+    if (isTrustedHost(host))
+      addCandidate(host);
+    else
+      qWarning() << "网关/DHCP 服务器不在本地网段, 已忽略:" << host;
+  }
+
+  const QUrl captiveUrl = m_api->profile().captiveUrl();
+  if (captiveUrl.isValid() && !captiveUrl.isEmpty()) {
+    QNetworkRequest request(captiveUrl);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                         QNetworkRequest::ManualRedirectPolicy);
+    request.setTransferTimeout(DEADLINE_MS);
+    m_captive = m_networkManager->get(request);
+    connect(m_captive, &QNetworkReply::finished, this,
+            &PortalDiscovery::onCaptiveFinished);
+  }
+
+  m_deadlineTimer->start(DEADLINE_MS);
+  qInfo() << "认证服务器不可达, 开始自动发现, 候选:" << m_probed;
+}
+
+void PortalDiscovery::addCandidate(const QString &candidate) {
+  QString host = candidate.trimmed();
+  if (host.isEmpty() || m_probed.contains(host))
+    return;
+  m_probed << host;
+
+  QUrl url = m_api->profile().statusUrl();
+  url.setHost(host);
+  url.setQuery(QString());
+  for (int port : PROBE_PORTS) {
+    url.setPort(port);
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::UserAgentHeader,
+                      PortalProfile::USER_AGENT);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                         QNetworkRequest::ManualRedirectPolicy);
+    request.setTransferTimeout(DEADLINE_MS);
+
+    QNetworkReply *reply = m_networkManager->get(request);
+    reply->setProperty("host", host);
+    reply->setProperty("port", port);
+    m_probes << reply;
+    connect(reply, &QNetworkReply::finished, this,
+            &PortalDiscovery::onProbeFinished);
+  }
+}
+
+void PortalDiscovery::onProbeFinished() {
+  QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+  if (!reply)
+    return;
+  m_probes.removeOne(reply);
+  reply->deleteLater();
+
+  if (reply->error() == QNetworkReply::NoError &&
+      isUserInfoResponse(reply->readAll())) {
+    // 最先返回有效响应的即为最快节点
+    finish(reply->property("host").toString(),
+           reply->property("port").toInt());
+    return;
+  }
+  if (m_probes.isEmpty() && !m_captive)
+    finish(QString(), 0);
+}
+
+void PortalDiscovery::onCaptiveFinished() {
+  QNetworkReply *reply = m_captive;
+  m_captive = nullptr;
+  reply->deleteLater();
+
+  // 只采用 HTTP 重定向 (及 meta refresh) 的目标, 不从页面正文中提取地址:
+  // 登录请求中的账号密码编码可逆, 不能发往页面内容能左右的主机
+  QUrl location =
+      reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+  if (!location.isValid()) {
+    static const QRegularExpression refreshRe(
+        "<meta[^>]+http-equiv\\s*=\\s*[\"']?refresh[^>]+"
+        "url\\s*=\\s*([^\"'>\\s]+)",
+        QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch match =
+        refreshRe.match(QString::fromUtf8(reply->read(64 * 1024)));
+    if (match.hasMatch())
+      location = QUrl(match.captured(1));
+  }
+
+  const QString host = reply->url().resolved(location).host();
+  if (location.isValid() && host != m_api->profile().captiveUrl().host()) {
+    if (isTrustedHost(host))
+      addCandidate(host);
+    else
+      qWarning() << "重定向目标不在本地网段且不属于门户配置, 已忽略:" << host;
+  }
+  if (m_probes.isEmpty())
+    finish(QString(), 0);
+}
+
+bool PortalDiscovery::isTrustedHost(const QString &host) const {
+  const PortalProfile &profile = m_api->profile();
+  if (host == profile.statusUrl().host() || profile.candidates().contains(host))
+    return true;
+
+  // 主机名需要解析才能判断网段, 一律不信任
+  const QHostAddress address(host);
+  if (address.isNull())
+    return false;
+  const auto interfaces = QNetworkInterface::allInterfaces();
+  for (const QNetworkInterface &iface : interfaces) {
+    if (iface.flags() & QNetworkInterface::IsLoopBack)
+      continue;
+    const auto entries = iface.addressEntries();
+    for (const QNetworkAddressEntry &entry : entries) {
+      if (entry.prefixLength() > 0 &&
+          address.isInSubnet(entry.ip(), entry.prefixLength()))
+        return true;
+    }
+  }
+  return false;
+}
+
+void PortalDiscovery::onDeadline() { finish(QString(), 0); }
+
+bool PortalDiscovery::isUserInfoResponse(const QByteArray &data) const {
+  // 通过校验的地址会收到登录请求, 只接受与门户配置完全一致的响应格式
+  const PortalProfile::Matcher &offline = m_api->profile().statusOffline();
+  const QByteArray body = data.trimmed();
+  if (body.isEmpty())
+    return false;
+  if (offline.matchesExactly(body))
+    return true;
+
+  // JSON / JSONP: 离线时 error 为离线标记, 在线时含完整的用户信息
+  const int open = body.indexOf('{');
+  const int close = body.lastIndexOf('}');
+  if (open >= 0 && close > open) {
+    QJsonParseError parseError;
+    const QJsonObject obj =
+        QJsonDocument::fromJson(body.mid(open, close - open + 1), &parseError)
+            .object();
+    if (parseError.error != QJsonParseError::NoError)
+      return false;
+    const QByteArray error = obj.value("error").toString().toUtf8();
+    if (!error.isEmpty())
+      return offline.matchesExactly(error) ||
+             (error.endsWith("_error") &&
+              offline.matchesExactly(error.chopped(6)));
+
+    const QJsonValue ip = obj.value("online_ip");
+    const QJsonValue user = obj.value("user_name");
+    const QJsonValue bytes = obj.value("sum_bytes");
+    const QJsonValue seconds = obj.value("sum_seconds");
+    return ip.isString() &&
+           QHostAddress(ip.toString()).protocol() ==
+               QAbstractSocket::IPv4Protocol &&
+           user.isString() && !user.toString().isEmpty() &&
+           (bytes.isUndefined() || bytes.isDouble()) &&
+           (seconds.isUndefined() || seconds.isDouble());
+  }
+
+  // CSV: username,seconds,ip,bytes,... 单行, 数值字段必须为非负整数
+  if (body.contains('\n') || body.contains('<'))
+    return false;
+  const QList<QByteArray> parts = body.split(',');
+  if (parts.size() < 4 || parts[0].trimmed().isEmpty())
+    return false;
+  bool secondsOk = false;
+  bool bytesOk = false;
+  parts[1].toULongLong(&secondsOk);
+  parts[3].toULongLong(&bytesOk);
+  return secondsOk && bytesOk &&
+         QHostAddress(QString::fromLatin1(parts[2])).protocol() ==
+             QAbstractSocket::IPv4Protocol;
+}
+
+void PortalDiscovery::finish(const QString &host, int port) {
+  if (!m_running)
+    return;
+  m_running = false;
+  m_deadlineTimer->stop();
+  abortAll();
+
+  qint64 elapsed = m_clock.elapsed();
+  if (host.isEmpty()) {
+    qWarning() << "未发现可用的认证服务器, 用时" << elapsed << "ms";
+    emit failed(elapsed);
+    return;
+  }
+
+  m_failures = 0;
+  m_api->setPortal(host, port);
+  saveCache(host, port);
+  Metrics::instance().set("portal_discovery_ms", elapsed);
+  qInfo() << "发现认证服务器:" << host << "端口" << port << "用时" << elapsed
+          << "ms";
+  emit discovered(host, port, elapsed);
+}
+
+void PortalDiscovery::abortAll() {
+  // abort 会同步发出 finished, 先断开连接
+  QList<QNetworkReply *> replies = m_probes;
+  if (m_captive)
+    replies << m_captive;
+  m_probes.clear();
+  m_captive = nullptr;
+
+  for (QNetworkReply *reply : replies) {
+    reply->disconnect(this);
+    reply->abort();
+    reply->deleteLater();
+  }
+}
+
+QString PortalDiscovery::cachePath() {
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+         "/portal-cache.json";
+}
+
+void PortalDiscovery::saveCache(const QString &host, int port) const {
+  QString path = cachePath();
+  QDir().mkpath(QFileInfo(path).absolutePath());
+
+  QJsonObject cache;
+  cache.insert("profile", m_api->profile().name());
+  cache.insert("host", host);
+  cache.insert("port", port);
+  cache.insert("gateway", m_gateway);
+
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning() << "无法写入认证服务器缓存:" << path;
+    return;
+  }
+  file.write(QJsonDocument(cache).toJson(QJsonDocument::Compact));
+}
+
+QStringList PortalDiscovery::defaultGateways() {
+  QStringList gateways;
+#if defined(Q_OS_LINUX)
+  // /proc/net/route: Iface Destination Gateway ..., 地址为网络字节序的十六进制
+  QFile file("/proc/net/route");
+  if (!file.open(QIODevice::ReadOnly))
+    return gateways;
+  file.readLine(); // 表头
+  while (!file.atEnd()) {
+    QList<QByteArray> fields = file.readLine().simplified().split(' ');
+    if (fields.size() < 3 || fields[1] != "00000000")
+      continue;
+    bool ok = false;
+    quint32 raw = fields[2].toUInt(&ok, 16);
+    if (ok && raw != 0)
+      gateways << QHostAddress(qFromBigEndian(raw)).toString();
+  }
+#elif defined(Q_OS_WIN)
+  ULONG size = 0;
+  if (GetIpForwardTable(nullptr, &size, FALSE) != ERROR_INSUFFICIENT_BUFFER)
+    return gateways;
+  QByteArray buffer(static_cast<int>(size), Qt::Uninitialized);
+  auto *table = reinterpret_cast<PMIB_IPFORWARDTABLE>(buffer.data());
+  if (GetIpForwardTable(table, &size, TRUE) != NO_ERROR)
+    return gateways;
+  for (DWORD i = 0; i < table->dwNumEntries; ++i) {
+    const MIB_IPFORWARDROW &row = table->table[i];
+    if (row.dwForwardDest == 0 && row.dwForwardMask == 0 &&
+        row.dwForwardNextHop != 0)
+      gateways << QHostAddress(qFromBigEndian<quint32>(row.dwForwardNextHop))
+                      .toString();
+  }
+#endif
+  gateways.removeDuplicates();
+  return gateways;
+}
+
+QStringList PortalDiscovery::dhcpServers() {
+  QStringList servers;
+#if defined(Q_OS_LINUX)
+  // systemd-networkd / NetworkManager 内置客户端: SERVER_ADDRESS=
+  // dhclient: option dhcp-server-identifier x.x.x.x;
+  static const QRegularExpression serverRe(
+      "(?:SERVER_ADDRESS=|dhcp-server-identifier\\s+)([0-9.]+)");
+  const QStringList dirs = {"/run/systemd/netif/leases",
+                            "/var/lib/NetworkManager", "/var/lib/dhcp",
+                            "/var/lib/dhclient"};
+  for (const QString &dir : dirs) {
+    const QFileInfoList files =
+        QDir(dir).entryInfoList({"*", "*.lease", "*.leases"}, QDir::Files);
+    for (const QFileInfo &info : files) {
+      QFile file(info.filePath());
+      if (!file.open(QIODevice::ReadOnly))
+        continue;
+      QRegularExpressionMatchIterator it =
+          serverRe.globalMatch(QString::fromLatin1(file.read(64 * 1024)));
+      while (it.hasNext())
+        servers << it.next().captured(1);
+    }
+  }
+#elif defined(Q_OS_WIN)
+  ULONG size = 0;
+  if (GetAdaptersInfo(nullptr, &size) != ERROR_BUFFER_OVERFLOW)
+    return servers;
+  QByteArray buffer(static_cast<int>(size), Qt::Uninitialized);
+  auto *adapter = reinterpret_cast<PIP_ADAPTER_INFO>(buffer.data());
+  if (GetAdaptersInfo(adapter, &size) != NO_ERROR)
+    return servers;
+  for (; adapter; adapter = adapter->Next) {
+    QString server = QString::fromLatin1(adapter->DhcpServer.IpAddress.String);
+    if (adapter->DhcpEnabled && !server.isEmpty() && server != "0.0.0.0")
+      servers << server;
+  }
+#endif
+  servers.removeDuplicates();
+  return servers;
+}
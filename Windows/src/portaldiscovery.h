@@ -0,0 +1,77 @@
+#ifndef PORTALDISCOVERY_H
+#define PORTALDISCOVERY_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+#include "api.h"
+
+// 认证服务器自动发现: 配置的地址不可达 (连续失败或默认网关变化) 时,
+// 并行探测默认网关、DHCP 服务器、强制门户重定向目标 (门户配置的 captive_url)
+// 与候选列表的 80/69 端口,
+// 以 rad_user_info 响应格式校验, 采用最快响应的地址并缓存供下次启动使用.
+// 网关、DHCP 服务器与重定向目标只有位于本地网段或属于门户配置时才参与探测;
+// 响应须与门户配置的状态格式完全一致 (完整的在线信息或精确的离线标记)
+class PortalDiscovery : public QObject {
+  Q_OBJECT
+
+public:
+  explicit PortalDiscovery(Api *api, QObject *parent = nullptr);
+  ~PortalDiscovery();
+
+  // 应用缓存的发现结果 (启动时及重新加载配置后调用)
+  bool applyCache();
+
+  // 立即开始一轮发现 (已在进行时忽略)
+  void discover();
+  bool isRunning() const { return m_running; }
+
+  static QStringList defaultGateways();
+  static QStringList dhcpServers();
+
+signals:
+  void discovered(const QString &host, int port, qint64 elapsedMs);
+  void failed(qint64 elapsedMs);
+
+private slots:
+  void onReachability(bool reachable);
+  void onProbeFinished();
+  void onCaptiveFinished();
+  void onDeadline();
+
+private:
+  void addCandidate(const QString &host);
+  // 本地网段内的地址, 或门户配置中的认证服务器/候选地址
+  bool isTrustedHost(const QString &host) const;
+  // 门户状态接口的响应: 精确的离线标记, 或字段类型正确的在线信息
+  bool isUserInfoResponse(const QByteArray &data) const;
+  void finish(const QString &host, int port);
+  void abortAll();
+  void saveCache(const QString &host, int port) const;
+  static QString cachePath();
+
+  Api *m_api;
+  QNetworkAccessManager *m_networkManager;
+  QTimer *m_deadlineTimer;
+  QElapsedTimer m_clock;
+  QElapsedTimer m_lastRun;
+
+  QStringList m_probed;
+  QList<QNetworkReply *> m_probes;
+  QNetworkReply *m_captive = nullptr;
+  QString m_gateway;
+  int m_failures = 0;
+  bool m_running = false;
+
+  static const int PROBE_PORTS[2];
+  static const int FAILURE_THRESHOLD;
+  static const int DEADLINE_MS;
+  static const int MIN_INTERVAL_MS;
+};
+
+#endif // PORTALDISCOVERY_H
@@ -0,0 +1,223 @@
+#include "portalerror.h"
+#include <QRandomGenerator>
+#include <array>
+
+namespace {
+
+using Code = PortalError::Code;
+using Policy = PortalError::Policy;
+using Info = PortalError::Info;
+
+// 错误码表; 增删条目后若 static_assert 报冲突, 调整 HASH_SEED 即可
+constexpr Info ERRORS[] = {
+    {"E2531", Code::UserNotFound, Policy::Stop, "用户不存在"},
+    {"E2532", Code::AuthTooFrequent, Policy::Backoff, "两次认证的间隔太短"},
+    {"E2533", Code::PasswordRetryLimit, Policy::Stop, "密码错误次数超过限制"},
+    {"E2534", Code::ProxyBanned, Policy::Backoff, "有代理行为, 账号被暂时禁用"},
+    {"E2535", Code::AuthDisabled, Policy::Stop, "认证系统已被禁用"},
+    {"E2536", Code::LicenseExpired, Policy::Stop, "系统授权已过期"},
+    {"E2553", Code::WrongPassword, Policy::Stop, "密码错误"},
+    {"E2601", Code::ClientNotAllowed, Policy::Stop, "不是专用客户端"},
+    {"E2602", Code::DeviceDisabled, Policy::Stop, "认证设备已被禁用"},
+    {"E2606", Code::UserDisabled, Policy::Stop, "用户已被禁用"},
+    {"E2607", Code::MacBindMismatch, Policy::Stop, "MAC 地址绑定错误"},
+    {"E2611", Code::IpBindMismatch, Policy::Stop, "IP 地址绑定错误"},
+    {"E2613", Code::NasPortBindMismatch, Policy::Stop, "NAS PORT 绑定错误"},
+    {"E2614", Code::VlanBindMismatch, Policy::Stop, "VLAN ID 绑定错误"},
+    {"E2616", Code::Arrears, Policy::Stop, "账号已欠费"},
+    {"E2620", Code::AlreadyOnline, Policy::Backoff, "账号已经在线"},
+    {"E2806", Code::NoProduct, Policy::Stop, "找不到符合条件的产品"},
+    {"E2807", Code::NoBillingPolicy, Policy::Stop, "找不到符合条件的计费策略"},
+    {"E2808", Code::NoControlPolicy, Policy::Stop, "找不到符合条件的控制策略"},
+    {"E2833", Code::AbnormalIp, Policy::Backoff, "IP 地址异常"},
+    {"E2840", Code::ExternalAccessDenied, Policy::Stop, "校内地址不允许访问外网"},
+    {"E2841", Code::IpBindMismatch, Policy::Stop, "IP 地址绑定错误"},
+    {"E2842", Code::NoAuthRequired, Policy::Stop, "IP 地址无需认证即可上网"},
+    {"E2843", Code::IpNotInTable, Policy::Backoff, "IP 地址不在 IP 表中"},
+    {"E2844", Code::IpBlacklisted, Policy::Stop, "IP 地址在黑名单中"},
+    {"E2901", Code::ThirdPartyAuthFailed, Policy::Backoff, "第三方认证失败"},
+    {"E3001", Code::QuotaExhausted, Policy::Stop, "流量或时长已用尽"},
+    {"E3002", Code::NoBillingPolicy, Policy::Stop, "计费策略条件不匹配"},
+    {"E3003", Code::NoControlPolicy, Policy::Stop, "控制策略条件不匹配"},
+    {"E3004", Code::Arrears, Policy::Stop, "余额不足"},
+    {"E3005", Code::PolicyChanging, Policy::RetryNow, "在线变更计费策略"},
+    {"E3006", Code::PolicyChanging, Policy::RetryNow, "在线变更控制策略"},
+    {"E5990", Code::IncompleteData, Policy::RetryNow, "数据不完整"},
+    {"E5991", Code::InvalidParameter, Policy::Stop, "无效的参数"},
+    {"E5992", Code::UserNotFound, Policy::Stop, "找不到该用户"},
+    {"E6500", Code::PortalNotRunning, Policy::Backoff, "认证程序未启动"},
+    {"E6504", Code::LogoutCooldown, Policy::Backoff, "刚刚注销, 请稍后登录"},
+    {"E6506", Code::WrongPassword, Policy::Stop, "用户名或密码错误"},
+    {"password_error", Code::WrongPassword, Policy::Stop, "密码错误"},
+    {"username_error", Code::UserNotFound, Policy::Stop, "用户名错误"},
+    {"user_tab_error", Code::UserNotFound, Policy::Stop, "认证程序未找到该用户"},
+    {"user_not_found", Code::UserNotFound, Policy::Stop, "用户不存在"},
+    {"status_error", Code::Arrears, Policy::Stop, "账号状态异常 (可能已欠费)"},
+    {"available_error", Code::UserDisabled, Policy::Stop, "账号已被禁用"},
+    {"ip_exist_error", Code::AlreadyOnline, Policy::Backoff, "IP 已在线"},
+    {"usernum_error", Code::UserNumLimit, Policy::Backoff, "在线设备数已达上限"},
+    {"online_num_error", Code::UserNumLimit, Policy::Backoff,
+     "在线设备数已达上限"},
+    {"mode_error", Code::ModeError, Policy::Stop, "认证方式不允许"},
+    {"time_policy_error", Code::TimePolicy, Policy::Backoff,
+     "当前时段不允许上网"},
+    {"flux_error", Code::QuotaExhausted, Policy::Stop, "流量已用尽"},
+    {"minutes_error", Code::QuotaExhausted, Policy::Stop, "时长已用尽"},
+    {"ip_error", Code::IpBindMismatch, Policy::Stop, "IP 地址错误"},
+    {"mac_error", Code::MacBindMismatch, Policy::Stop, "MAC 地址错误"},
+    {"sync_error", Code::SyncError, Policy::Backoff, "认证数据同步失败"},
+    {"not_online_error", Code::NotOnline, Policy::RetryNow, "当前不在线"},
+    {"ip_already_online_error", Code::AlreadyOnline, Policy::Backoff,
+     "IP 已在线"},
+};
+
+constexpr int ERROR_COUNT = sizeof(ERRORS) / sizeof(ERRORS[0]);
+constexpr int TABLE_SIZE = 256;
+constexpr quint32 HASH_SEED = 119;
+
+constexpr quint32 hashKey(const char *key, int length) {
+  // FNV-1a, 取中间 8 位作为槽位
+  quint32 h = 2166136261u ^ HASH_SEED;
+  for (int i = 0; i < length; ++i) {
+    h ^= static_cast<unsigned char>(key[i]);
+    h *= 16777619u;
+  }
+  return (h >> 8) & (TABLE_SIZE - 1);
+}
+
+constexpr int keyLength(const char *key) {
+  int length = 0;
+  while (key[length] != '\0')
+    ++length;
+  return length;
+}
+
+constexpr std::array<qint8, TABLE_SIZE> buildIndex() {
+  std::array<qint8, TABLE_SIZE> index{};
+  for (int i = 0; i < TABLE_SIZE; ++i)
+    index[i] = -1;
+  for (int i = 0; i < ERROR_COUNT; ++i)
+    index[hashKey(ERRORS[i].key, keyLength(ERRORS[i].key))] =
+        static_cast<qint8>(i);
+  return index;
+}
+
+constexpr bool isPerfect() {
+  for (int i = 0; i < ERROR_COUNT; ++i) {
+    for (int j = i + 1; j < ERROR_COUNT; ++j) {
+      if (hashKey(ERRORS[i].key, keyLength(ERRORS[i].key)) ==
+          hashKey(ERRORS[j].key, keyLength(ERRORS[j].key)))
+        return false;
+    }
+  }
+  return true;
+}
+
+static_assert(ERROR_COUNT < 128, "错误码表过大");
+static_assert(isPerfect(), "错误码哈希冲突, 请调整 HASH_SEED");
+
+constexpr std::array<qint8, TABLE_SIZE> INDEX = buildIndex();
+
+const Info UNKNOWN = {"", Code::Unknown, Policy::Backoff, "未知错误"};
+const Info NETWORK = {"", Code::Network, Policy::Backoff, "网络错误"};
+
+bool isKeyChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+} // namespace
+
+const PortalError::Info *PortalError::lookup(const char *key, int length) {
+  const int slot = INDEX[hashKey(key, length)];
+  if (slot < 0)
+    return nullptr;
+
+  const Info &info = ERRORS[slot];
+  if (qstrncmp(info.key, key, length) != 0 || info.key[length] != '\0')
+    return nullptr;
+  return &info;
+}
+
+const PortalError::Info &PortalError::fromResponse(const QByteArray &response) {
+  const char *data = response.constData();
+  const int size = response.size();
+
+  // 1. E 开头的 4 位数字错误码
+  for (int i = 0; i + 4 < size; ++i) {
+    if (data[i] != 'E')
+      continue;
+    int digits = 0;
+    while (i + 1 + digits < size && data[i + 1 + digits] >= '0' &&
+           data[i + 1 + digits] <= '9')
+      ++digits;
+    if (digits == 4) {
+      if (const Info *info = lookup(data + i, 5))
+        return *info;
+    }
+  }
+
+  // 2. 小写下划线形式的错误标识 (如 password_error)
+  for (int i = 0; i < size;) {
+    if (!isKeyChar(data[i])) {
+      ++i;
+      continue;
+    }
+    int start = i;
+    while (i < size && isKeyChar(data[i]))
+      ++i;
+    if (const Info *info = lookup(data + start, i - start))
+      return *info;
+  }
+
+  return UNKNOWN;
+}
+
+const PortalError::Info &PortalError::unknown() { return UNKNOWN; }
+
+const PortalError::Info &PortalError::network() { return NETWORK; }
+
+bool PortalError::isServerFault(const Info &info) {
+  switch (info.code) {
+  case Code::PortalNotRunning:
+  case Code::SyncError:
+  case Code::ThirdPartyAuthFailed:
+  case Code::IncompleteData:
+    return true;
+  default:
+    return false;
+  }
+}
+
+const int LoginRetry::MAX_IMMEDIATE_RETRIES = 2;
+const qint64 LoginRetry::BASE_BACKOFF_MS = 5 * 1000;
+const qint64 LoginRetry::MAX_BACKOFF_MS = 5 * 60 * 1000;
+
+void LoginRetry::reset() {
+  m_attempts = 0;
+  m_immediateRetries = 0;
+  m_blocked = false;
+}
+
+qint64 LoginRetry::onFailure(PortalError::Policy policy) {
+  ++m_attempts;
+
+  switch (policy) {
+  case PortalError::Policy::Stop:
+    m_blocked = true;
+    return -1;
+  case PortalError::Policy::RetryNow:
+    if (m_immediateRetries < MAX_IMMEDIATE_RETRIES) {
+      ++m_immediateRetries;
+      return 0;
+    }
+    break;
+  case PortalError::Policy::Backoff:
+    break;
+  }
+
+  // 指数退避 + 随机抖动: 5s, 10s, 20s ... 最长 5 分钟
+  const int exponent = qMin(m_attempts - 1, 6);
+  const qint64 delay = qMin(BASE_BACKOFF_MS << exponent, MAX_BACKOFF_MS);
+  QRandomGenerator *rng = m_rng ? m_rng : QRandomGenerator::global();
+  return delay / 2 + rng->bounded(delay / 2 + 1);
+}
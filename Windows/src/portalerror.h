@@ -0,0 +1,106 @@
+#ifndef PORTALERROR_H
+#define PORTALERROR_H
+
+#include <QByteArray>
+#include <QString>
+
+class QRandomGenerator;
+
+// SRUN 门户错误码表: 编译期完美哈希查找, 每个错误码附带重试策略
+class PortalError {
+public:
+  enum class Code {
+    None,
+    Unknown,
+    Network, // 网络错误, 未收到门户响应
+
+    UserNotFound,
+    WrongPassword,
+    PasswordRetryLimit,
+    UserDisabled,
+    Arrears,
+    QuotaExhausted,
+    UserNumLimit,
+    AlreadyOnline,
+    NotOnline,
+    AuthTooFrequent,
+    ProxyBanned,
+    AuthDisabled,
+    LicenseExpired,
+    ClientNotAllowed,
+    DeviceDisabled,
+    MacBindMismatch,
+    IpBindMismatch,
+    NasPortBindMismatch,
+    VlanBindMismatch,
+    NoProduct,
+    NoBillingPolicy,
+    NoControlPolicy,
+    AbnormalIp,
+    ExternalAccessDenied,
+    NoAuthRequired,
+    IpNotInTable,
+    IpBlacklisted,
+    ThirdPartyAuthFailed,
+    PolicyChanging,
+    IncompleteData,
+    InvalidParameter,
+    PortalNotRunning,
+    LogoutCooldown,
+    ModeError,
+    TimePolicy,
+    SyncError
+  };
+
+  enum class Policy {
+    RetryNow, // 瞬时错误, 立即重试
+    Backoff,  // 稍后重试 (指数退避)
+    Stop      // 重试无效, 停止自动登录并提醒用户
+  };
+
+  struct Info {
+    const char *key; // 错误码或门户返回的错误标识
+    Code code;
+    Policy policy;
+    const char *message;
+  };
+
+  // 按错误标识 (如 "E2553", "password_error") 查表, 未收录时返回 nullptr
+  static const Info *lookup(const char *key, int length);
+  // 从登录响应中提取错误码并查表, 未识别时返回 Unknown
+  static const Info &fromResponse(const QByteArray &response);
+
+  static const Info &unknown();
+  static const Info &network();
+
+  // 是否反映认证服务器自身故障 (计入熔断); 未识别的响应不算,
+  // 服务器故障由 5xx/超时在 Api::classifyError 中判断
+  static bool isServerFault(const Info &info);
+};
+
+// 自动登录重试状态: 按错误策略计算下次自动登录的等待时间
+class LoginRetry {
+public:
+  void reset();
+
+  // 抖动使用的随机数源 (仿真时注入固定种子), 默认全局随机数
+  void setRandomGenerator(QRandomGenerator *rng) { m_rng = rng; }
+
+  // 登录失败后调用, 返回距下次自动登录的毫秒数; 返回 -1 表示停止自动登录
+  qint64 onFailure(PortalError::Policy policy);
+
+  bool blocked() const { return m_blocked; }
+  int attempts() const { return m_attempts; }
+
+private:
+  int m_attempts = 0;
+  int m_immediateRetries = 0;
+  bool m_blocked = false;
+  QRandomGenerator *m_rng = nullptr;
+
+  static const int MAX_IMMEDIATE_RETRIES;
+  static const qint64 BASE_BACKOFF_MS;
+  static const qint64 MAX_BACKOFF_MS;
+};
+
+#endif // PORTALERROR_H
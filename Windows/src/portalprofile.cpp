@@ -0,0 +1,272 @@
+#include "portalprofile.h"
+#include "encryption.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QStandardPaths>
+
+const QByteArray PortalProfile::USER_AGENT = "HAUTNetworkGuard/1.3.5 Qt";
+
+namespace {
+
+struct ProfileSet {
+  QString defaultName;
+  QList<QJsonObject> profiles;
+};
+
+void mergeProfiles(ProfileSet &set, const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+
+  QJsonParseError parseError;
+  QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+  if (!doc.isObject()) {
+    qWarning() << "门户配置解析失败:" << path << parseError.errorString();
+    return;
+  }
+
+  QJsonObject root = doc.object();
+  if (root.contains("default"))
+    set.defaultName = root.value("default").toString();
+
+  // 同名配置由后加载的文件覆盖
+  const QJsonArray profiles = root.value("profiles").toArray();
+  for (const QJsonValue &value : profiles) {
+    QJsonObject obj = value.toObject();
+    QString name = obj.value("name").toString();
+    bool replaced = false;
+    for (QJsonObject &existing : set.profiles) {
+      if (existing.value("name").toString() == name) {
+        existing = obj;
+        replaced = true;
+        break;
+      }
+    }
+    if (!replaced)
+      set.profiles.append(obj);
+  }
+}
+
+// 内置配置 + 用户配置目录下的 portals.json
+ProfileSet readProfiles() {
+  ProfileSet set;
+  mergeProfiles(set, ":/portals.json");
+  QString userDir =
+      QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+  mergeProfiles(set, QDir(userDir).filePath("portals.json"));
+  return set;
+}
+
+} // namespace
+
+QByteArray PortalProfile::RequestTemplate::build(const QString &username,
+                                                 const QString &password) const {
+  QByteArray encUsername, encPassword;
+  int size = m_literalSize;
+  for (const Segment &segment : m_segments) {
+    if (segment.slot == Slot::Username && encUsername.isNull()) {
+      encUsername = QUrl::toPercentEncoding(username);
+      size += encUsername.size();
+    } else if (segment.slot == Slot::Password && encPassword.isNull()) {
+      encPassword = QUrl::toPercentEncoding(password);
+      size += encPassword.size();
+    }
+  }
+
+  QByteArray body;
+  body.reserve(size);
+  for (const Segment &segment : m_segments) {
+    switch (segment.slot) {
+    case Slot::Literal:
+      body.append(segment.literal);
+      break;
+    case Slot::Username:
+      body.append(encUsername);
+      break;
+    case Slot::Password:
+      body.append(encPassword);
+      break;
+    }
+  }
+  return body;
+}
+
+bool PortalProfile::RequestTemplate::compile(const QUrl &url,
+                                             const QJsonArray &fields,
+                                             QString *error) {
+  m_segments.clear();
+  m_literalSize = 0;
+
+  request = QNetworkRequest(url);
+  request.setHeader(QNetworkRequest::ContentTypeHeader,
+                    "application/x-www-form-urlencoded");
+  request.setHeader(QNetworkRequest::UserAgentHeader, USER_AGENT);
+  request.setTransferTimeout(10000);
+
+  // 相邻字面量合并为一个片段
+  QByteArray pending;
+  auto flush = [this, &pending]() {
+    if (pending.isEmpty())
+      return;
+    m_literalSize += pending.size();
+    m_segments.append({Slot::Literal, pending});
+    pending.clear();
+  };
+
+  for (int i = 0; i < fields.size(); ++i) {
+    QJsonArray pair = fields.at(i).toArray();
+    if (pair.size() != 2) {
+      *error = QString("第 %1 个字段格式错误").arg(i + 1);
+      return false;
+    }
+
+    if (i > 0)
+      pending.append('&');
+    pending.append(QUrl::toPercentEncoding(pair.at(0).toString()));
+    pending.append('=');
+
+    QString value = pair.at(1).toString();
+    if (value == "{username}") {
+      flush();
+      m_segments.append({Slot::Username, QByteArray()});
+    } else if (value == "{password}") {
+      flush();
+      m_segments.append({Slot::Password, QByteArray()});
+    } else {
+      pending.append(QUrl::toPercentEncoding(value));
+    }
+  }
+  flush();
+  return true;
+}
+
+void PortalProfile::Matcher::compile(const QJsonArray &patterns) {
+  m_matchers.clear();
+  for (const QJsonValue &pattern : patterns)
+    m_matchers.append(QByteArrayMatcher(pattern.toString().toUtf8()));
+}
+
+bool PortalProfile::Matcher::matches(const QByteArray &data) const {
+  for (const QByteArrayMatcher &matcher : m_matchers) {
+    if (matcher.indexIn(data) >= 0)
+      return true;
+  }
+  return false;
+}
+
+bool PortalProfile::Matcher::matchesExactly(const QByteArray &data) const {
+  for (const QByteArrayMatcher &matcher : m_matchers) {
+    if (matcher.pattern() == data)
+      return true;
+  }
+  return false;
+}
+
+PortalProfile PortalProfile::load(const QString &name) {
+  ProfileSet set = readProfiles();
+
+  const QString wanted = name.isEmpty() ? set.defaultName : name;
+  const QJsonObject *selected = nullptr;
+  for (const QJsonObject &obj : set.profiles) {
+    if (obj.value("name").toString() == wanted) {
+      selected = &obj;
+      break;
+    }
+  }
+  if (!selected) {
+    qWarning() << "未找到门户配置" << wanted << ", 使用默认配置";
+    for (const QJsonObject &obj : set.profiles) {
+      if (obj.value("name").toString() == set.defaultName) {
+        selected = &obj;
+        break;
+      }
+    }
+  }
+
+  PortalProfile profile;
+  QString error;
+  if (!selected) {
+    qWarning() << "没有可用的门户配置";
+  } else if (!profile.compile(*selected, &error)) {
+    qWarning() << "门户配置无效:" << wanted << error;
+  }
+  return profile;
+}
+
+QStringList PortalProfile::availableProfiles() {
+  QStringList names;
+  const ProfileSet set = readProfiles();
+  for (const QJsonObject &obj : set.profiles)
+    names.append(obj.value("name").toString());
+  return names;
+}
+
+bool PortalProfile::compile(const QJsonObject &obj, QString *error) {
+  m_name = obj.value("name").toString();
+  m_title = obj.value("title").toString(m_name);
+  m_statusUrl = QUrl(obj.value("status_url").toString());
+  m_loginUrl = QUrl(obj.value("login_url").toString());
+  if (!m_statusUrl.isValid() || !m_loginUrl.isValid() ||
+      m_statusUrl.isEmpty() || m_loginUrl.isEmpty()) {
+    *error = "status_url/login_url 无效";
+    return false;
+  }
+
+  QString encryption = obj.value("encryption").toString("srun3k");
+  if (encryption == "srun3k") {
+    m_encryption = Encryption::Srun3k;
+  } else if (encryption == "plain") {
+    m_encryption = Encryption::Plain;
+  } else {
+    *error = QString("不支持的加密方式: %1").arg(encryption);
+    return false;
+  }
+
+  if (!m_loginTemplate.compile(m_loginUrl,
+                               obj.value("login_fields").toArray(), error) ||
+      !m_logoutTemplate.compile(m_loginUrl,
+                                obj.value("logout_fields").toArray(), error))
+    return false;
+
+  m_statusRequest = QNetworkRequest(m_statusUrl);
+  m_statusRequest.setHeader(QNetworkRequest::UserAgentHeader, USER_AGENT);
+  m_statusRequest.setTransferTimeout(5000);
+
+  m_captiveUrl = QUrl(obj.value("captive_url").toString());
+  m_keepAliveUrl = QUrl(obj.value("keepalive_url").toString());
+  m_candidates.clear();
+  for (const QJsonValue &value : obj.value("candidates").toArray())
+    m_candidates << value.toString();
+
+  QJsonObject matchers = obj.value("matchers").toObject();
+  m_loginSuccess.compile(matchers.value("login_success").toArray());
+  m_logoutSuccess.compile(matchers.value("logout_success").toArray());
+  m_statusOffline.compile(matchers.value("status_offline").toArray());
+
+  m_valid = true;
+  return true;
+}
+
+QString PortalProfile::encodeUsername(const QString &username) const {
+  if (m_encryption == Encryption::Srun3k)
+    return ::Encryption::encryptUsername(username);
+  return username;
+}
+
+QString PortalProfile::encodePassword(const QString &password) const {
+  if (m_encryption == Encryption::Srun3k)
+    return ::Encryption::encryptPassword(password);
+  return password;
+}
+
+void PortalProfile::setPortal(const QString &host, int statusPort) {
+  m_statusUrl.setHost(host);
+  m_statusUrl.setPort(statusPort == 80 ? -1 : statusPort);
+  m_loginUrl.setHost(host);
+
+  m_statusRequest.setUrl(m_statusUrl);
+  m_loginTemplate.request.setUrl(m_loginUrl);
+  m_logoutTemplate.request.setUrl(m_loginUrl);
+}
@@ -0,0 +1,109 @@
+#ifndef PORTALPROFILE_H
+#define PORTALPROFILE_H
+
+#include <QByteArray>
+#include <QByteArrayMatcher>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QNetworkRequest>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+
+// 认证门户配置: 从 portals.json 加载, 加载时编译为请求模板和响应匹配器,
+// 每次请求只做拼接, 不再解析配置或逐字段构建表单
+class PortalProfile {
+public:
+  enum class Encryption { Srun3k, Plain };
+
+  // 预编译的表单请求: 字面量已完成 URL 编码, 只在占位处填入账号/密码
+  class RequestTemplate {
+  public:
+    QNetworkRequest request;
+
+    QByteArray build(const QString &username = QString(),
+                     const QString &password = QString()) const;
+    bool compile(const QUrl &url, const QJsonArray &fields,
+                 QString *error);
+
+  private:
+    enum class Slot { Literal, Username, Password };
+    struct Segment {
+      Slot slot;
+      QByteArray literal;
+    };
+    QList<Segment> m_segments;
+    int m_literalSize = 0;
+  };
+
+  // 预编译的响应匹配器: 任一模式命中即匹配
+  class Matcher {
+  public:
+    void compile(const QJsonArray &patterns);
+    bool matches(const QByteArray &data) const;
+    // 整段内容与某个模式完全相同
+    bool matchesExactly(const QByteArray &data) const;
+
+  private:
+    QList<QByteArrayMatcher> m_matchers;
+  };
+
+  PortalProfile() = default;
+
+  // 按名称加载配置; 找不到时回退到默认配置
+  static PortalProfile load(const QString &name);
+  // 所有可用配置名称
+  static QStringList availableProfiles();
+
+  bool isValid() const { return m_valid; }
+  QString name() const { return m_name; }
+  QString title() const { return m_title; }
+  Encryption encryption() const { return m_encryption; }
+
+  QUrl statusUrl() const { return m_statusUrl; }
+  QUrl loginUrl() const { return m_loginUrl; }
+  const QNetworkRequest &statusRequest() const { return m_statusRequest; }
+  const RequestTemplate &loginTemplate() const { return m_loginTemplate; }
+  const RequestTemplate &logoutTemplate() const { return m_logoutTemplate; }
+
+  const Matcher &loginSuccess() const { return m_loginSuccess; }
+  const Matcher &logoutSuccess() const { return m_logoutSuccess; }
+  const Matcher &statusOffline() const { return m_statusOffline; }
+
+  // 自动发现用的候选认证服务器地址
+  QStringList candidates() const { return m_candidates; }
+  // 强制门户检测地址: 未认证时网关会把它重定向到认证页, 为空时不检测
+  QUrl captiveUrl() const { return m_captiveUrl; }
+  // 保活请求地址 (小流量), 内置配置不设置, 需在用户配置中显式开启
+  QUrl keepAliveUrl() const { return m_keepAliveUrl; }
+  // 切换到发现的认证服务器: 替换所有请求的主机名, 状态查询使用 statusPort
+  void setPortal(const QString &host, int statusPort);
+
+  // 按配置的加密方式处理账号/密码
+  QString encodeUsername(const QString &username) const;
+  QString encodePassword(const QString &password) const;
+
+  static const QByteArray USER_AGENT;
+
+private:
+  bool compile(const QJsonObject &obj, QString *error);
+
+  bool m_valid = false;
+  QString m_name;
+  QString m_title;
+  Encryption m_encryption = Encryption::Srun3k;
+  QUrl m_statusUrl;
+  QUrl m_loginUrl;
+  QStringList m_candidates;
+  QUrl m_captiveUrl;
+  QUrl m_keepAliveUrl;
+  QNetworkRequest m_statusRequest;
+  RequestTemplate m_loginTemplate;
+  RequestTemplate m_logoutTemplate;
+  Matcher m_loginSuccess;
+  Matcher m_logoutSuccess;
+  Matcher m_statusOffline;
+};
+
+#endif // PORTALPROFILE_H
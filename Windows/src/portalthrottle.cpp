@@ -0,0 +1,162 @@
+#include "portalthrottle.h"
+#include "metrics.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QRandomGenerator>
+
+const double PortalThrottle::BUCKET_CAPACITY = 6.0;
+const double PortalThrottle::REFILL_PER_SECOND = 0.5;
+const int PortalThrottle::FAILURE_THRESHOLD = 5;
+const qint64 PortalThrottle::BASE_COOLDOWN_MS = 30 * 1000;
+const qint64 PortalThrottle::MAX_COOLDOWN_MS = 10 * 60 * 1000;
+
+PortalThrottle &PortalThrottle::instance() {
+  static PortalThrottle instance;
+  return instance;
+}
+
+PortalThrottle::PortalThrottle()
+    : m_tokens(BUCKET_CAPACITY), m_cooldownMs(BASE_COOLDOWN_MS) {
+  m_clock.start();
+}
+
+PortalThrottle::Admission PortalThrottle::acquire() {
+  Admission admission = Admission::Allowed;
+  bool changed = false;
+  State newState;
+  {
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = m_clock.elapsed();
+    refill(now);
+
+    if (m_state == State::Open && now >= m_openUntil) {
+      setState(State::HalfOpen, now);
+      changed = true;
+    }
+
+    if (m_state == State::Open ||
+        (m_state == State::HalfOpen && m_probeInFlight)) {
+      admission = Admission::CircuitOpen;
+    } else if (m_tokens < 1.0) {
+      admission = Admission::RateLimited;
+    } else {
+      m_tokens -= 1.0;
+      if (m_state == State::HalfOpen) {
+        m_probeInFlight = true;
+        admission = Admission::Probe;
+      }
+    }
+
+    if (admission == Admission::CircuitOpen ||
+        admission == Admission::RateLimited) {
+      ++m_rejected;
+      Metrics::instance().set("throttle_rejected", m_rejected);
+    }
+    newState = m_state;
+  }
+
+  // 信号在锁外发出, 避免槽函数重入
+  if (changed)
+    emit stateChanged(newState);
+  if (admission == Admission::CircuitOpen ||
+      admission == Admission::RateLimited)
+    emit rejected(admission);
+  return admission;
+}
+
+void PortalThrottle::record(Outcome outcome) {
+  bool changed = false;
+  State newState;
+  {
+    QMutexLocker locker(&m_mutex);
+    const qint64 now = m_clock.elapsed();
+    const State before = m_state;
+    const bool wasProbe = m_state == State::HalfOpen && m_probeInFlight;
+    if (wasProbe)
+      m_probeInFlight = false;
+
+    switch (outcome) {
+    case Outcome::Success:
+      m_consecutiveFailures = 0;
+      if (wasProbe) {
+        m_cooldownMs = BASE_COOLDOWN_MS;
+        setState(State::Closed, now);
+      }
+      break;
+    case Outcome::Failure:
+      ++m_consecutiveFailures;
+      if (wasProbe) {
+        // 探测失败: 冷却时间加倍
+        m_cooldownMs = qMin(m_cooldownMs * 2, MAX_COOLDOWN_MS);
+        setState(State::Open, now);
+      } else if (m_state == State::Closed &&
+                 m_consecutiveFailures >= FAILURE_THRESHOLD) {
+        setState(State::Open, now);
+      }
+      break;
+    case Outcome::Neutral:
+      // 探测结果无法说明服务器状态, 按原冷却时间重新等待
+      if (wasProbe)
+        setState(State::Open, now);
+      break;
+    }
+
+    changed = m_state != before;
+    newState = m_state;
+  }
+
+  if (changed)
+    emit stateChanged(newState);
+}
+
+PortalThrottle::State PortalThrottle::state() const {
+  QMutexLocker locker(&m_mutex);
+  return m_state;
+}
+
+qint64 PortalThrottle::rejectedCount() const {
+  QMutexLocker locker(&m_mutex);
+  return m_rejected;
+}
+
+qint64 PortalThrottle::retryAfterMs() const {
+  QMutexLocker locker(&m_mutex);
+  if (m_state != State::Open)
+    return 0;
+  return qMax<qint64>(0, m_openUntil - m_clock.elapsed());
+}
+
+QString PortalThrottle::stateText(State state) {
+  switch (state) {
+  case State::Closed:
+    return "正常";
+  case State::Open:
+    return "熔断中";
+  case State::HalfOpen:
+    return "探测恢复中";
+  }
+  return QString();
+}
+
+void PortalThrottle::refill(qint64 now) {
+  const qint64 elapsed = now - m_lastRefill;
+  m_lastRefill = now;
+  m_tokens = qMin(BUCKET_CAPACITY,
+                  m_tokens + elapsed * REFILL_PER_SECOND / 1000.0);
+}
+
+void PortalThrottle::setState(State state, qint64 now) {
+  if (state == State::Open) {
+    // ±20% 抖动, 错开大量客户端的恢复时间
+    const double jitter =
+        0.8 + QRandomGenerator::global()->generateDouble() * 0.4;
+    m_openUntil = now + static_cast<qint64>(m_cooldownMs * jitter);
+    Metrics::instance().add("breaker_opened");
+    qWarning() << "认证服务器熔断, 冷却" << (m_openUntil - now) << "ms";
+  } else if (state == State::Closed) {
+    m_consecutiveFailures = 0;
+    qInfo() << "认证服务器恢复, 熔断关闭";
+  }
+  m_state = state;
+  Metrics::instance().set("breaker_state", static_cast<int>(state));
+}
@@ -0,0 +1,77 @@
+#ifndef PORTALTHROTTLE_H
+#define PORTALTHROTTLE_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+
+// 认证服务器保护: 所有 Api 请求共享的令牌桶限流 + 熔断器
+// 连续超时/5xx/E 错误码达到阈值后熔断, 冷却期后只放行一个半开探测请求,
+// 探测成功则恢复, 失败则加倍冷却时间 (带随机抖动, 避免大量客户端同时恢复)
+class PortalThrottle : public QObject {
+  Q_OBJECT
+
+public:
+  enum class State { Closed, Open, HalfOpen };
+  Q_ENUM(State)
+
+  enum class Admission {
+    Allowed,
+    Probe,       // 半开状态下的唯一探测请求
+    RateLimited, // 令牌耗尽
+    CircuitOpen  // 熔断中
+  };
+
+  enum class Outcome {
+    Success, // 服务器正常响应
+    Failure, // 超时/5xx/E 错误码
+    Neutral  // 与服务器健康无关 (如本机断网)
+  };
+
+  static PortalThrottle &instance();
+
+  // 请求前申请许可; Allowed/Probe 之外的结果都应放弃本次请求
+  Admission acquire();
+  // 每个获得许可的请求结束后必须报告结果
+  void record(Outcome outcome);
+
+  State state() const;
+  qint64 rejectedCount() const;
+  // 熔断剩余冷却时间 (毫秒)
+  qint64 retryAfterMs() const;
+
+  static QString stateText(State state);
+
+signals:
+  void stateChanged(PortalThrottle::State state);
+  void rejected(PortalThrottle::Admission admission);
+
+private:
+  PortalThrottle();
+
+  void refill(qint64 now);
+  void setState(State state, qint64 now);
+
+  mutable QMutex m_mutex;
+  QElapsedTimer m_clock;
+
+  // 令牌桶
+  double m_tokens;
+  qint64 m_lastRefill = 0;
+
+  // 熔断器
+  State m_state = State::Closed;
+  int m_consecutiveFailures = 0;
+  bool m_probeInFlight = false;
+  qint64 m_openUntil = 0;
+  qint64 m_cooldownMs;
+  qint64 m_rejected = 0;
+
+  static const double BUCKET_CAPACITY;
+  static const double REFILL_PER_SECOND;
+  static const int FAILURE_THRESHOLD;
+  static const qint64 BASE_COOLDOWN_MS;
+  static const qint64 MAX_COOLDOWN_MS;
+};
+
+#endif // PORTALTHROTTLE_H
@@ -0,0 +1,335 @@
+#include "powermonitor.h"
+#include "metrics.h"
+#include <QCoreApplication>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <QDir>
+#include <QFile>
+#include <QSocketNotifier>
+#include <cerrno>
+#include <ctime>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#else
+#include <QNetworkInformation>
+#endif
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+
+namespace {
+// GUID_CONSOLE_DISPLAY_STATE / GUID_ACDC_POWER_SOURCE, 避免依赖 uuid.lib
+const GUID DISPLAY_STATE = {
+    0x6fe69556, 0x704a, 0x47a0, {0x8f, 0x24, 0xc2, 0x8d, 0x93, 0x6f, 0xda, 0x47}};
+const GUID POWER_SOURCE = {
+    0x5d3e9a59, 0xe9d5, 0x4b00, {0xa6, 0xbd, 0xff, 0x34, 0xff, 0x51, 0x65, 0x48}};
+} // namespace
+#endif
+
+const qint64 PowerMonitor::WAKEUP_WINDOW_MS = 60 * 60 * 1000;
+// 挂起超过 2 秒才算休眠, 排除手动校时等时钟跳变
+const qint64 PowerMonitor::RESUME_THRESHOLD_MS = 2000;
+const qint64 PowerMonitor::BATTERY_CACHE_MS = 60 * 1000;
+
+QElapsedTimer PowerMonitor::s_wakeupWindow;
+qint64 PowerMonitor::s_wakeups = 0;
+qint64 PowerMonitor::s_switchesAtWindowStart = -1;
+
+namespace {
+
+// 进程自愿上下文切换次数 (每次睡眠后被唤醒计一次), 不支持时返回 -1
+qint64 voluntarySwitches() {
+#ifdef Q_OS_LINUX
+  rusage usage;
+  if (::getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_nvcsw;
+#endif
+  return -1;
+}
+
+} // namespace
+
+PowerMonitor::PowerMonitor(QObject *parent) : QObject(parent) {
+#ifdef Q_OS_WIN
+  SYSTEM_POWER_STATUS status;
+  if (GetSystemPowerStatus(&status))
+    m_onBattery = status.ACLineStatus == 0;
+  QCoreApplication::instance()->installNativeEventFilter(this);
+#endif
+
+#ifdef Q_OS_LINUX
+  // 休眠唤醒会使 CANCEL_ON_SET 定时器被取消, 据此得到通知而无需轮询
+  m_clockFd = ::timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (m_clockFd >= 0) {
+    armClockWatch();
+    m_clockNotifier =
+        new QSocketNotifier(m_clockFd, QSocketNotifier::Read, this);
+    connect(m_clockNotifier, &QSocketNotifier::activated, this,
+            &PowerMonitor::onClockChanged);
+  }
+
+  // 网卡获得 IPv4 地址 (连上网线/Wi-Fi, DHCP 完成)
+  m_netlinkFd = ::socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                         NETLINK_ROUTE);
+  if (m_netlinkFd >= 0) {
+    sockaddr_nl addr = {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_IPV4_IFADDR;
+    if (::bind(m_netlinkFd, reinterpret_cast<sockaddr *>(&addr),
+               sizeof(addr)) == 0) {
+      m_netlinkNotifier =
+          new QSocketNotifier(m_netlinkFd, QSocketNotifier::Read, this);
+      connect(m_netlinkNotifier, &QSocketNotifier::activated, this,
+              &PowerMonitor::onNetlink);
+    } else {
+      ::close(m_netlinkFd);
+      m_netlinkFd = -1;
+    }
+  }
+
+  // 交流电源插拔、电池充放电切换时内核广播 power_supply uevent
+  m_onBattery = readBattery();
+  m_ueventFd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        NETLINK_KOBJECT_UEVENT);
+  if (m_ueventFd >= 0) {
+    sockaddr_nl addr = {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = 1; // 内核广播组
+    if (::bind(m_ueventFd, reinterpret_cast<sockaddr *>(&addr),
+               sizeof(addr)) == 0) {
+      m_ueventNotifier =
+          new QSocketNotifier(m_ueventFd, QSocketNotifier::Read, this);
+      connect(m_ueventNotifier, &QSocketNotifier::activated, this,
+              &PowerMonitor::onUevent);
+    } else {
+      ::close(m_ueventFd);
+      m_ueventFd = -1;
+    }
+  }
+#else
+  if (QNetworkInformation::loadBackendByFeatures(
+          QNetworkInformation::Feature::Reachability)) {
+    QNetworkInformation *info = QNetworkInformation::instance();
+    m_reachability = static_cast<int>(info->reachability());
+    connect(info, &QNetworkInformation::reachabilityChanged, this,
+            [this](QNetworkInformation::Reachability reachability) {
+              // 门户认证前只有局域网可达, 从断开变为 Local 及以上即视为恢复
+              const int local =
+                  static_cast<int>(QNetworkInformation::Reachability::Local);
+              const bool wasUp = m_reachability >= local;
+              m_reachability = static_cast<int>(reachability);
+              if (!wasUp && m_reachability >= local)
+                emit networkUp();
+            });
+  }
+#endif
+}
+
+PowerMonitor::~PowerMonitor() {
+#ifdef Q_OS_WIN
+  QCoreApplication::instance()->removeNativeEventFilter(this);
+  if (m_displayNotify)
+    UnregisterPowerSettingNotification(m_displayNotify);
+  if (m_sourceNotify)
+    UnregisterPowerSettingNotification(m_sourceNotify);
+#endif
+#ifdef Q_OS_LINUX
+  if (m_clockFd >= 0)
+    ::close(m_clockFd);
+  if (m_netlinkFd >= 0)
+    ::close(m_netlinkFd);
+  if (m_ueventFd >= 0)
+    ::close(m_ueventFd);
+#endif
+}
+
+void PowerMonitor::registerWindow(quintptr windowHandle) {
+#ifdef Q_OS_WIN
+  // 注册后系统会立即发送一次当前状态
+  HWND hwnd = reinterpret_cast<HWND>(windowHandle);
+  if (!m_displayNotify)
+    m_displayNotify = RegisterPowerSettingNotification(
+        hwnd, &DISPLAY_STATE, DEVICE_NOTIFY_WINDOW_HANDLE);
+  if (!m_sourceNotify)
+    m_sourceNotify = RegisterPowerSettingNotification(
+        hwnd, &POWER_SOURCE, DEVICE_NOTIFY_WINDOW_HANDLE);
+#else
+  Q_UNUSED(windowHandle);
+#endif
+}
+
+bool PowerMonitor::onBattery() const {
+#ifdef Q_OS_LINUX
+  // 有 uevent 通知时状态始终是最新的
+  if (m_ueventFd >= 0)
+    return m_onBattery;
+  if (m_batteryChecked.isValid() &&
+      m_batteryChecked.elapsed() < BATTERY_CACHE_MS)
+    return m_onBattery;
+  m_batteryChecked.start();
+  m_onBattery = readBattery();
+#endif
+  return m_onBattery;
+}
+
+void PowerMonitor::setPowerState(bool onBattery, bool displayOff) {
+  const bool wasLowPower = m_onBattery || m_displayOff;
+  m_onBattery = onBattery;
+  m_displayOff = displayOff;
+  const bool lowPower = m_onBattery || m_displayOff;
+  Metrics::instance().set("power_low", lowPower ? 1 : 0);
+  if (lowPower != wasLowPower) {
+    qInfo() << (lowPower ? "进入低功耗状态" : "退出低功耗状态")
+            << "电池供电:" << m_onBattery << "显示器关闭:" << m_displayOff;
+    emit lowPowerChanged(lowPower);
+  }
+}
+
+void PowerMonitor::countWakeup() {
+  if (!s_wakeupWindow.isValid()) {
+    s_wakeupWindow.start();
+    s_switchesAtWindowStart = voluntarySwitches();
+  }
+  ++s_wakeups;
+
+  const qint64 elapsed = s_wakeupWindow.elapsed();
+  if (elapsed < WAKEUP_WINDOW_MS)
+    return;
+
+  // 按实际窗口长度折算为每小时
+  Metrics &metrics = Metrics::instance();
+  const qint64 perHour = s_wakeups * 3600000 / elapsed;
+  metrics.set("timer_wakeups_per_hour", perHour);
+  const qint64 switches = voluntarySwitches();
+  if (switches >= 0 && s_switchesAtWindowStart >= 0) {
+    // 含网络/IPC 等全部唤醒
+    metrics.set("process_wakeups_per_hour",
+                (switches - s_switchesAtWindowStart) * 3600000 / elapsed);
+  }
+  qInfo() << "定时器唤醒" << perHour << "次/小时";
+
+  s_wakeupWindow.restart();
+  s_wakeups = 0;
+  s_switchesAtWindowStart = switches;
+}
+
+bool PowerMonitor::nativeEventFilter(const QByteArray &eventType,
+                                     void *message, qintptr *result) {
+  Q_UNUSED(result);
+#ifdef Q_OS_WIN
+  if (eventType != "windows_generic_MSG")
+    return false;
+  const MSG *msg = static_cast<const MSG *>(message);
+  if (msg->message != WM_POWERBROADCAST)
+    return false;
+
+  if (msg->wParam == PBT_APMRESUMEAUTOMATIC) {
+    qInfo() << "系统从休眠中唤醒";
+    emit resumed();
+  } else if (msg->wParam == PBT_POWERSETTINGCHANGE) {
+    const POWERBROADCAST_SETTING *setting =
+        reinterpret_cast<const POWERBROADCAST_SETTING *>(msg->lParam);
+    if (setting->DataLength < sizeof(DWORD))
+      return false;
+    const DWORD value = *reinterpret_cast<const DWORD *>(setting->Data);
+    // 显示器: 0 关闭, 1 打开, 2 变暗; 电源: 0 交流, 1 电池, 2 UPS
+    if (IsEqualGUID(setting->PowerSetting, DISPLAY_STATE))
+      setPowerState(m_onBattery, value == 0);
+    else if (IsEqualGUID(setting->PowerSetting, POWER_SOURCE))
+      setPowerState(value != 0, m_displayOff);
+  }
+#else
+  Q_UNUSED(eventType);
+  Q_UNUSED(message);
+#endif
+  return false;
+}
+
+#ifdef Q_OS_LINUX
+qint64 PowerMonitor::suspendedMs() {
+  // CLOCK_BOOTTIME 包含挂起时间, CLOCK_MONOTONIC 不包含
+  timespec boot, mono;
+  ::clock_gettime(CLOCK_BOOTTIME, &boot);
+  ::clock_gettime(CLOCK_MONOTONIC, &mono);
+  return (boot.tv_sec - mono.tv_sec) * 1000 +
+         (boot.tv_nsec - mono.tv_nsec) / 1000000;
+}
+
+void PowerMonitor::armClockWatch() {
+  // 远期的绝对时间定时器, 只用于接收时钟不连续变化的通知
+  itimerspec spec = {};
+  spec.it_value.tv_sec = 0x7fffffff;
+  ::timerfd_settime(m_clockFd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET,
+                    &spec, nullptr);
+  m_suspendedMs = suspendedMs();
+}
+
+void PowerMonitor::onClockChanged() {
+  quint64 expirations = 0;
+  ssize_t ignored = ::read(m_clockFd, &expirations, sizeof(expirations));
+  Q_UNUSED(ignored); // 被取消时返回 ECANCELED, 重新设置即可
+
+  const qint64 previous = m_suspendedMs;
+  armClockWatch();
+  if (m_suspendedMs - previous > RESUME_THRESHOLD_MS) {
+    qInfo() << "系统从休眠中唤醒, 挂起" << (m_suspendedMs - previous) / 1000
+            << "秒";
+    emit resumed();
+  }
+}
+
+bool PowerMonitor::readBattery() {
+  // 任一电池处于放电状态即视为电池供电; 台式机/服务器没有电池
+  QDir dir("/sys/class/power_supply");
+  const QStringList supplies = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+  for (const QString &name : supplies) {
+    QFile type(dir.filePath(name + "/type"));
+    if (!type.open(QIODevice::ReadOnly) || type.readAll().trimmed() != "Battery")
+      continue;
+    QFile status(dir.filePath(name + "/status"));
+    if (status.open(QIODevice::ReadOnly) &&
+        status.readAll().trimmed() == "Discharging")
+      return true;
+  }
+  return false;
+}
+
+void PowerMonitor::onUevent() {
+  // 消息为 "动作@路径\0键=值\0..." 的序列
+  char buffer[4096];
+  bool powerSupply = false;
+  for (;;) {
+    ssize_t n = ::recv(m_ueventFd, buffer, sizeof(buffer), 0);
+    if (n <= 0)
+      break;
+    if (QByteArray::fromRawData(buffer, static_cast<int>(n))
+            .contains("SUBSYSTEM=power_supply"))
+      powerSupply = true;
+  }
+  if (powerSupply)
+    setPowerState(readBattery(), m_displayOff);
+}
+
+void PowerMonitor::onNetlink() {
+  char buffer[4096];
+  bool addressAdded = false;
+  for (;;) {
+    ssize_t n = ::recv(m_netlinkFd, buffer, sizeof(buffer), 0);
+    if (n <= 0)
+      break;
+    int len = static_cast<int>(n);
+    for (const nlmsghdr *header = reinterpret_cast<const nlmsghdr *>(buffer);
+         NLMSG_OK(header, len); header = NLMSG_NEXT(header, len)) {
+      if (header->nlmsg_type == RTM_NEWADDR)
+        addressAdded = true;
+    }
+  }
+  if (addressAdded)
+    emit networkUp();
+}
+#endif
@@ -0,0 +1,81 @@
+#ifndef POWERMONITOR_H
+#define POWERMONITOR_H
+
+#include <QAbstractNativeEventFilter>
+#include <QElapsedTimer>
+#include <QObject>
+
+class QSocketNotifier;
+
+// 电源与网络事件:
+// - 休眠唤醒 (Windows: WM_POWERBROADCAST; Linux: 时钟跳变通知 + CLOCK_BOOTTIME)
+// - 网卡获得地址 (Linux: netlink; 其它平台: QNetworkInformation)
+// - 低功耗: 显示器关闭或电池供电 (Linux 只检测电池, 经 uevent 通知)
+// 另统计本进程定时器唤醒次数, 每小时发布到 Metrics
+class PowerMonitor : public QObject, public QAbstractNativeEventFilter {
+  Q_OBJECT
+
+public:
+  explicit PowerMonitor(QObject *parent = nullptr);
+  ~PowerMonitor();
+
+  // Windows: 在顶层窗口上注册显示器与电源变化通知
+  void registerWindow(quintptr windowHandle);
+
+  bool lowPower() const { return onBattery() || m_displayOff; }
+  bool onBattery() const;
+  bool displayOff() const { return m_displayOff; }
+
+  // 每次定时器回调调用一次
+  static void countWakeup();
+
+  bool nativeEventFilter(const QByteArray &eventType, void *message,
+                         qintptr *result) override;
+
+signals:
+  void resumed();
+  void networkUp();
+  void lowPowerChanged(bool lowPower);
+
+private:
+  void setPowerState(bool onBattery, bool displayOff);
+
+  mutable bool m_onBattery = false; // Linux 上按需刷新
+  bool m_displayOff = false;
+
+#ifdef Q_OS_WIN
+  void *m_displayNotify = nullptr;
+  void *m_sourceNotify = nullptr;
+#endif
+
+#ifdef Q_OS_LINUX
+  void armClockWatch();
+  void onClockChanged();
+  void onNetlink();
+  void onUevent();
+  static qint64 suspendedMs();
+  static bool readBattery();
+
+  int m_clockFd = -1;
+  int m_netlinkFd = -1;
+  int m_ueventFd = -1;
+  QSocketNotifier *m_clockNotifier = nullptr;
+  QSocketNotifier *m_netlinkNotifier = nullptr;
+  QSocketNotifier *m_ueventNotifier = nullptr;
+  qint64 m_suspendedMs = 0;
+  // 无法接收 uevent 时电池状态按需读取 sysfs, 短时间内复用结果
+  mutable QElapsedTimer m_batteryChecked;
+#else
+  int m_reachability = 0;
+#endif
+
+  static QElapsedTimer s_wakeupWindow;
+  static qint64 s_wakeups;
+  static qint64 s_switchesAtWindowStart;
+
+  static const qint64 WAKEUP_WINDOW_MS;
+  static const qint64 RESUME_THRESHOLD_MS;
+  static const qint64 BATTERY_CACHE_MS;
+};
+
+#endif // POWERMONITOR_H
@@ -0,0 +1,57 @@
+#include "proxycache.h"
+#include "metrics.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+CachingProxyFactory::CachingProxyFactory(int ttlSeconds)
+    : m_ttlMs(ttlSeconds * 1000) {}
+
+QList<QNetworkProxy>
+CachingProxyFactory::queryProxy(const QNetworkProxyQuery &query) {
+  const QString key = cacheKey(query);
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+  {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_cache.constFind(key);
+    if (it != m_cache.constEnd() && it->expiresAt > now) {
+      Metrics::instance().add("proxy_cache_hits");
+      return it->proxies;
+    }
+  }
+
+  // 系统代理查询可能很慢 (PAC 脚本/WPAD), 不在锁内执行
+  QElapsedTimer timer;
+  timer.start();
+  QList<QNetworkProxy> proxies = systemProxyForQuery(query);
+  qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+
+  Metrics::instance().add("proxy_resolve_count");
+  Metrics::instance().add("proxy_resolve_us", elapsedUs);
+  qDebug() << "代理解析" << key << "用时" << elapsedUs << "us";
+
+  if (proxies.isEmpty())
+    proxies.append(QNetworkProxy(QNetworkProxy::NoProxy));
+
+  QMutexLocker locker(&m_mutex);
+  m_cache.insert(key, {proxies, now + m_ttlMs});
+  return proxies;
+}
+
+void CachingProxyFactory::clear() {
+  QMutexLocker locker(&m_mutex);
+  m_cache.clear();
+}
+
+void CachingProxyFactory::install() {
+  QNetworkProxyFactory::setApplicationProxyFactory(new CachingProxyFactory());
+}
+
+QString CachingProxyFactory::cacheKey(const QNetworkProxyQuery &query) {
+  return QString("%1|%2://%3:%4")
+      .arg(static_cast<int>(query.queryType()))
+      .arg(query.protocolTag(), query.peerHostName())
+      .arg(query.peerPort());
+}
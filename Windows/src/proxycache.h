@@ -0,0 +1,37 @@
+#ifndef PROXYCACHE_H
+#define PROXYCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QNetworkProxy>
+#include <QNetworkProxyFactory>
+
+// 按目标缓存系统代理决策, 避免每次请求都做 WPAD/PAC 计算
+// 解析耗时计入 Metrics: proxy_resolve_us / proxy_resolve_count / proxy_cache_hits
+class CachingProxyFactory : public QNetworkProxyFactory {
+public:
+  explicit CachingProxyFactory(int ttlSeconds = 300);
+
+  QList<QNetworkProxy>
+  queryProxy(const QNetworkProxyQuery &query = QNetworkProxyQuery()) override;
+
+  void clear();
+
+  // 安装为应用级代理工厂 (未单独设置代理的 QNetworkAccessManager 生效)
+  static void install();
+
+private:
+  struct Entry {
+    QList<QNetworkProxy> proxies;
+    qint64 expiresAt;
+  };
+
+  static QString cacheKey(const QNetworkProxyQuery &query);
+
+  int m_ttlMs;
+  QMutex m_mutex;
+  QHash<QString, Entry> m_cache;
+};
+
+#endif // PROXYCACHE_H
@@ -0,0 +1,208 @@
+#include "qualitymonitor.h"
+#include "metrics.h"
+#include "powermonitor.h"
+#include <QDebug>
+
+const int QualityMonitor::PROBE_INTERVAL_MS = 5000;
+const int QualityMonitor::PROBE_TIMEOUT_MS = 2000;
+// 每个目标约 2 KB, 三个目标控制在个位数 KB
+const int QualityMonitor::MAX_TARGETS = 3;
+
+QualityMonitor::QualityMonitor(QObject *parent)
+    : QObject(parent), m_tickTimer(new QTimer(this)),
+      m_sweepTimer(new QTimer(this)) {
+  m_clock.start();
+
+  m_tickTimer->setInterval(PROBE_INTERVAL_MS);
+  m_tickTimer->setTimerType(Qt::VeryCoarseTimer);
+  connect(m_tickTimer, &QTimer::timeout, this, &QualityMonitor::tick);
+
+  m_sweepTimer->setSingleShot(true);
+  m_sweepTimer->setInterval(PROBE_TIMEOUT_MS);
+  connect(m_sweepTimer, &QTimer::timeout, this, &QualityMonitor::sweep);
+}
+
+QualityMonitor::~QualityMonitor() { stop(); }
+
+void QualityMonitor::setTargets(const QStringList &targets) {
+  stop();
+  m_targets.clear();
+
+  for (const QString &entry : targets) {
+    QString text = entry.trimmed();
+    if (text.isEmpty())
+      continue;
+    if (m_targets.size() >= MAX_TARGETS) {
+      qWarning() << "质量监测目标过多, 忽略:" << text;
+      continue;
+    }
+
+    Target target;
+    int colon = text.lastIndexOf(':');
+    bool ok = false;
+    quint16 port = colon > 0 ? text.mid(colon + 1).toUShort(&ok) : 0;
+    target.host = ok ? text.left(colon) : text;
+    if (ok && port > 0)
+      target.port = port;
+    m_targets.append(target);
+  }
+}
+
+QStringList QualityMonitor::targets() const {
+  QStringList result;
+  for (const Target &target : m_targets)
+    result << QString("%1:%2").arg(target.host).arg(target.port);
+  return result;
+}
+
+void QualityMonitor::start() {
+  if (m_targets.isEmpty() || m_tickTimer->isActive())
+    return;
+  m_tickTimer->start();
+  tick();
+  Metrics::instance().set("quality_memory_bytes", memoryBytes());
+}
+
+void QualityMonitor::stop() {
+  m_tickTimer->stop();
+  m_sweepTimer->stop();
+  for (Target &target : m_targets) {
+    if (target.probe) {
+      target.probe->disconnect(this);
+      target.probe->abort();
+      target.probe->deleteLater();
+      target.probe = nullptr;
+    }
+  }
+}
+
+void QualityMonitor::tick() {
+  PowerMonitor::countWakeup();
+  for (Target &target : m_targets) {
+    if (!target.probe)
+      startProbe(target);
+  }
+  m_sweepTimer->start();
+}
+
+void QualityMonitor::startProbe(Target &target) {
+  const int index = static_cast<int>(&target - m_targets.data());
+
+  target.probe = new QTcpSocket(this);
+  connect(target.probe, &QTcpSocket::connected, this,
+          [this, index]() { finishProbe(m_targets[index], true); });
+  connect(target.probe, &QTcpSocket::errorOccurred, this,
+          [this, index](QAbstractSocket::SocketError error) {
+            // 连接被拒 (RST) 同样是一次完整往返
+            finishProbe(m_targets[index],
+                        error == QAbstractSocket::ConnectionRefusedError);
+          });
+  target.sent.start();
+  target.probe->connectToHost(target.host, target.port);
+}
+
+void QualityMonitor::finishProbe(Target &target, bool answered) {
+  if (!target.probe)
+    return;
+
+  const qint64 now = m_clock.elapsed();
+  if (answered) {
+    const qint64 rttUs = target.sent.nsecsElapsed() / 1000;
+    target.minute.addRtt(now, rttUs);
+    target.hour.addRtt(now, rttUs);
+    if (target.lastRttUs >= 0) {
+      // 抖动: 相邻两次 RTT 之差的平均值 (RFC 3550 的简化形式)
+      const qint64 delta = qAbs(rttUs - target.lastRttUs);
+      target.minute.addJitter(now, delta);
+      target.hour.addJitter(now, delta);
+    }
+    target.lastRttUs = rttUs;
+  } else {
+    target.minute.addLoss(now);
+    target.hour.addLoss(now);
+  }
+
+  target.probe->disconnect(this);
+  target.probe->abort();
+  target.probe->deleteLater();
+  target.probe = nullptr;
+
+  for (const Target &other : m_targets) {
+    if (other.probe)
+      return;
+  }
+  // 本轮探测全部结束
+  m_sweepTimer->stop();
+  publishMetrics();
+  emit updated();
+}
+
+void QualityMonitor::sweep() {
+  // 超时仍未完成的探测记为丢失
+  for (Target &target : m_targets) {
+    if (target.probe)
+      finishProbe(target, false);
+  }
+}
+
+QualityMonitor::Summary QualityMonitor::summary(int target,
+                                                Window window) const {
+  Summary result;
+  if (target < 0 || target >= m_targets.size())
+    return result;
+
+  const Target &t = m_targets.at(target);
+  const qint64 now = m_clock.elapsed();
+  const LatencyHistogram histogram = window == Window::Minute
+                                         ? t.minute.merged(now)
+                                         : t.hour.merged(now);
+  result.p50Us = histogram.percentileUs(0.50);
+  result.p95Us = histogram.percentileUs(0.95);
+  result.p99Us = histogram.percentileUs(0.99);
+  result.jitterUs = histogram.meanJitterUs();
+  result.loss = histogram.lossRate();
+  result.probes = histogram.probes();
+  return result;
+}
+
+QualityMonitor::Grade QualityMonitor::grade() const {
+  const Summary s = summary(0, Window::Minute);
+  if (s.probes == 0)
+    return Grade::Unknown;
+  if (s.loss >= 0.05 || s.p95Us < 0 || s.p95Us >= 300000)
+    return Grade::Poor;
+  if (s.loss >= 0.01 || s.p95Us >= 100000 || s.jitterUs >= 30000)
+    return Grade::Fair;
+  return Grade::Good;
+}
+
+int QualityMonitor::memoryBytes() const {
+  int bytes = static_cast<int>(sizeof(*this));
+  for (const Target &target : m_targets)
+    bytes += target.minute.memoryBytes() + target.hour.memoryBytes();
+  return bytes;
+}
+
+QString QualityMonitor::gradeText(Grade grade) {
+  switch (grade) {
+  case Grade::Good:
+    return "良好";
+  case Grade::Fair:
+    return "一般";
+  case Grade::Poor:
+    return "较差";
+  case Grade::Unknown:
+    break;
+  }
+  return "未知";
+}
+
+void QualityMonitor::publishMetrics() {
+  const Summary s = summary(0, Window::Minute);
+  Metrics &metrics = Metrics::instance();
+  metrics.set("quality_rtt_p50_us", s.p50Us);
+  metrics.set("quality_rtt_p95_us", s.p95Us);
+  metrics.set("quality_rtt_p99_us", s.p99Us);
+  metrics.set("quality_jitter_us", s.jitterUs);
+  metrics.set("quality_loss_permille", qRound(s.loss * 1000));
+}
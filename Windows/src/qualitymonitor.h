@@ -0,0 +1,85 @@
+#ifndef QUALITYMONITOR_H
+#define QUALITYMONITOR_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QVector>
+
+#include "latencyhistogram.h"
+
+// 网络质量监测: 定期向认证服务器及配置的目标发起 TCP 连接探测,
+// 在 1 分钟/1 小时滑动窗口内统计 RTT 分位数、抖动与丢失率
+class QualityMonitor : public QObject {
+  Q_OBJECT
+
+public:
+  enum class Grade { Unknown, Good, Fair, Poor };
+  Q_ENUM(Grade)
+
+  enum class Window { Minute, Hour };
+
+  struct Summary {
+    qint64 p50Us = -1;
+    qint64 p95Us = -1;
+    qint64 p99Us = -1;
+    qint64 jitterUs = -1;
+    double loss = 0.0;
+    int probes = 0;
+  };
+
+  explicit QualityMonitor(QObject *parent = nullptr);
+  ~QualityMonitor();
+
+  // 目标格式 host[:port], 默认端口 80; 超出上限的目标被忽略
+  void setTargets(const QStringList &targets);
+  QStringList targets() const;
+
+  void start();
+  void stop();
+  bool isRunning() const { return m_tickTimer->isActive(); }
+
+  Summary summary(int target, Window window) const;
+  // 以第一个目标 (认证服务器) 最近 1 分钟的统计评级
+  Grade grade() const;
+  int memoryBytes() const;
+
+  static QString gradeText(Grade grade);
+
+signals:
+  void updated();
+
+private slots:
+  void tick();
+  void sweep();
+
+private:
+  struct Target {
+    Target() : minute(10 * 1000, 6), hour(5 * 60 * 1000, 12) {}
+
+    QString host;
+    quint16 port = 80;
+    QTcpSocket *probe = nullptr;
+    QElapsedTimer sent;
+    qint64 lastRttUs = -1;
+    LatencyWindow minute;
+    LatencyWindow hour;
+  };
+
+  void startProbe(Target &target);
+  void finishProbe(Target &target, bool answered);
+  void publishMetrics();
+
+  QVector<Target> m_targets;
+  QTimer *m_tickTimer;
+  QTimer *m_sweepTimer;
+  QElapsedTimer m_clock;
+
+  static const int PROBE_INTERVAL_MS;
+  static const int PROBE_TIMEOUT_MS;
+  static const int MAX_TARGETS;
+};
+
+#endif // QUALITYMONITOR_H
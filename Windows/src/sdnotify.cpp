@@ -0,0 +1,50 @@
+#include "sdnotify.h"
+#include <QCoreApplication>
+
+#ifdef Q_OS_LINUX
+#include <cstddef>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+bool SdNotify::notify(const QByteArray &state) {
+#ifdef Q_OS_LINUX
+  const QByteArray path = qgetenv("NOTIFY_SOCKET");
+  if (path.isEmpty())
+    return false;
+
+  sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (static_cast<size_t>(path.size()) >= sizeof(addr.sun_path))
+    return false;
+  std::memcpy(addr.sun_path, path.constData(), path.size());
+  // '@' 开头表示抽象命名空间
+  if (addr.sun_path[0] == '@')
+    addr.sun_path[0] = '\0';
+
+  int fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    return false;
+
+  socklen_t len =
+      static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size());
+  ssize_t sent = ::sendto(fd, state.constData(), state.size(), MSG_NOSIGNAL,
+                          reinterpret_cast<sockaddr *>(&addr), len);
+  ::close(fd);
+  return sent == state.size();
+#else
+  Q_UNUSED(state);
+  return false;
+#endif
+}
+
+qint64 SdNotify::watchdogUsec() {
+  // WATCHDOG_PID 指向其他进程时说明看门狗不是给本进程的
+  const QByteArray pid = qgetenv("WATCHDOG_PID");
+  if (!pid.isEmpty() && pid.toLongLong() != QCoreApplication::applicationPid())
+    return 0;
+  return qgetenv("WATCHDOG_USEC").toLongLong();
+}
@@ -0,0 +1,17 @@
+#ifndef SDNOTIFY_H
+#define SDNOTIFY_H
+
+#include <QByteArray>
+
+// systemd 通知协议 (sd_notify) 的最小实现, 不依赖 libsystemd
+// 非 systemd 环境 (未设置 NOTIFY_SOCKET) 下所有调用均为空操作
+class SdNotify {
+public:
+  // 发送状态, 如 "READY=1", "WATCHDOG=1", "STOPPING=1"
+  static bool notify(const QByteArray &state);
+
+  // 看门狗超时 (微秒), 未启用时返回 0
+  static qint64 watchdogUsec();
+};
+
+#endif // SDNOTIFY_H
@@ -0,0 +1,73 @@
+#include "sessionmodel.h"
+#include <algorithm>
+
+const int SessionModel::MAX_SAMPLES = 8;
+const qint64 SessionModel::MIN_IDLE_MS = 2 * 60 * 1000;
+// 门户的会话时长策略以小时计, 更短的掉线多为链路中断, 不参与学习
+const qint64 SessionModel::MIN_LIFETIME_MS = 30 * 60 * 1000;
+const qint64 SessionModel::TOLERANCE_MS = 2 * 60 * 1000;
+
+void SessionModel::onlineSample(qint64 nowMs, qint64 secondsOnline,
+                                qint64 bytesUsed) {
+  // sum_seconds 只有秒级精度, 且与本机时钟存在采样误差
+  qint64 start = secondsOnline > 0 ? nowMs - secondsOnline * 1000 : -1;
+  bool newSession = !m_inSession;
+  if (m_inSession && start >= 0 && start - m_sessionStartMs > 60 * 1000)
+    newSession = true; // 在线时长归零: 会话已在两次查询之间重建
+
+  if (newSession) {
+    m_inSession = true;
+    m_sessionStartMs = start >= 0 ? start : nowMs;
+    m_lastTrafficMs = nowMs;
+  } else if (bytesUsed != m_lastBytes) {
+    m_lastTrafficMs = nowMs;
+  }
+  m_lastBytes = bytesUsed;
+  m_lastSampleMs = nowMs;
+}
+
+void SessionModel::sessionDropped(qint64 nowMs) {
+  if (!m_inSession)
+    return;
+  m_inSession = false;
+
+  // 掉线发生在最后一次在线样本与本次之间, 取中点
+  const qint64 dropMs = (m_lastSampleMs + nowMs) / 2;
+  const qint64 lifetime = dropMs - m_sessionStartMs;
+  const qint64 idle = dropMs - m_lastTrafficMs;
+
+  // 整个会话都没有流量时无法区分两者, 按会话寿命处理
+  if (idle >= MIN_IDLE_MS && idle < lifetime * 9 / 10)
+    remember(m_idleTimes, idle);
+  else if (lifetime >= MIN_LIFETIME_MS)
+    remember(m_lifetimes, lifetime);
+}
+
+void SessionModel::sessionEnded() { m_inSession = false; }
+
+qint64 SessionModel::predictedLifetimeMs() const {
+  return consistentMinimum(m_lifetimes);
+}
+
+qint64 SessionModel::predictedIdleMs() const {
+  return consistentMinimum(m_idleTimes);
+}
+
+void SessionModel::remember(QList<qint64> &samples, qint64 value) {
+  samples.append(value);
+  if (samples.size() > MAX_SAMPLES)
+    samples.removeFirst();
+}
+
+qint64 SessionModel::consistentMinimum(const QList<qint64> &samples) {
+  // 最近三次 (至少两次) 的结果彼此接近才认为是门户策略, 而非偶发断线
+  if (samples.size() < 2)
+    return -1;
+  const int count = qMin<int>(3, samples.size());
+  auto first = samples.cend() - count;
+  const qint64 low = *std::min_element(first, samples.cend());
+  const qint64 high = *std::max_element(first, samples.cend());
+  if (high - low > qMax(TOLERANCE_MS, low / 10))
+    return -1;
+  return low;
+}
@@ -0,0 +1,45 @@
+#ifndef SESSIONMODEL_H
+#define SESSIONMODEL_H
+
+#include <QList>
+#include <QtGlobal>
+
+// 会话寿命学习: 根据状态查询返回的在线时长 (sum_seconds) 与流量,
+// 从观测到的掉线中区分会话到期与空闲超时, 多次结果一致时给出预测
+class SessionModel {
+public:
+  // 在线状态样本; secondsOnline 为 0 时以首次观测为会话开始
+  void onlineSample(qint64 nowMs, qint64 secondsOnline, qint64 bytesUsed);
+  // 门户侧掉线 (非本机注销/刷新), 记录本次会话寿命或空闲时长
+  void sessionDropped(qint64 nowMs);
+  // 本机主动结束会话 (注销/刷新), 不参与学习
+  void sessionEnded();
+
+  bool inSession() const { return m_inSession; }
+  qint64 sessionStartMs() const { return m_sessionStartMs; }
+  qint64 lastTrafficMs() const { return m_lastTrafficMs; }
+
+  // 预测的会话寿命/空闲超时, 尚无一致结论时返回 -1
+  qint64 predictedLifetimeMs() const;
+  qint64 predictedIdleMs() const;
+
+private:
+  static void remember(QList<qint64> &samples, qint64 value);
+  static qint64 consistentMinimum(const QList<qint64> &samples);
+
+  bool m_inSession = false;
+  qint64 m_sessionStartMs = 0;
+  qint64 m_lastSampleMs = 0;
+  qint64 m_lastTrafficMs = 0;
+  qint64 m_lastBytes = 0;
+
+  QList<qint64> m_lifetimes;
+  QList<qint64> m_idleTimes;
+
+  static const int MAX_SAMPLES;
+  static const qint64 MIN_IDLE_MS;
+  static const qint64 MIN_LIFETIME_MS;
+  static const qint64 TOLERANCE_MS;
+};
+
+#endif // SESSIONMODEL_H
@@ -0,0 +1,281 @@
+#include "simulation.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QList>
+#include <QTextStream>
+#include <functional>
+
+// 断线重连状态机的虚拟时间仿真: 以离散事件时钟运行数天的场景,
+// 输出请求数、上线用时与离线时长, 任一场景不满足预期时返回非零
+namespace {
+
+const qint64 SECOND = 1000;
+const qint64 MINUTE = 60 * SECOND;
+const qint64 HOUR = 60 * MINUTE;
+const qint64 DAY = 24 * HOUR;
+
+QTextStream &out() {
+  static QTextStream stream(stdout);
+  return stream;
+}
+
+struct Case {
+  SimScenario scenario;
+  // 返回空字符串表示通过, 否则为失败原因
+  std::function<QString(const SimScenario &, const SimResult &)> check;
+};
+
+QString checkOnlineWithin(const SimScenario &s, const SimResult &r) {
+  qint64 limit =
+      s.bootMs + s.behavior.statusLatencyMs + s.behavior.loginLatencyMs;
+  if (r.timeToOnlineMs < 0 || r.timeToOnlineMs > limit)
+    return QString("上线用时 %1 ms, 预期不超过 %2 ms")
+        .arg(r.timeToOnlineMs)
+        .arg(limit);
+  return QString();
+}
+
+// 每次会话失效或主动刷新最多一次登录, 失效后在一个检测周期内恢复
+QString checkSessionRecovery(const SimScenario &s, const SimResult &r) {
+  QString error = checkOnlineWithin(s, r);
+  if (!error.isEmpty())
+    return error;
+  if (r.loginRequests > r.sessionsExpired + r.refreshes + 1)
+    return QString("登录 %1 次, 会话失效 %2 次, 主动刷新 %3 次")
+        .arg(r.loginRequests)
+        .arg(r.sessionsExpired)
+        .arg(r.refreshes);
+  qint64 perRecovery = s.checkIntervalMs + s.behavior.statusLatencyMs +
+                       s.behavior.loginLatencyMs;
+  // 主动刷新时注销 + 登录期间短暂离线
+  qint64 limit = s.bootMs + (r.sessionsExpired + 1) * perRecovery +
+                 r.refreshes * 2 * s.behavior.loginLatencyMs;
+  if (r.offlineMs > limit)
+    return QString("离线 %1 ms, 预期不超过 %2 ms").arg(r.offlineMs).arg(limit);
+  return QString();
+}
+
+// 会话寿命固定时, 学习两次后应在到期前主动刷新, 不再掉线
+QString checkSessionLearning(const SimScenario &s, const SimResult &r) {
+  QString error = checkSessionRecovery(s, r);
+  if (!error.isEmpty())
+    return error;
+  if (r.sessionsExpired > 2 || r.outagesAvoided == 0)
+    return QString("会话失效 %1 次, 主动刷新避免 %2 次")
+        .arg(r.sessionsExpired)
+        .arg(r.outagesAvoided);
+  return QString();
+}
+
+// 刷新会话的注销被拦截: 记为刷新失败, 会话到期后照常恢复,
+// 之后的会话仍按时刷新 (状态机不能卡在刷新中)
+QString checkRefreshRejected(const SimScenario &s, const SimResult &r) {
+  QString error = checkSessionRecovery(s, r);
+  if (!error.isEmpty())
+    return error;
+  if (r.refreshFailures != s.behavior.rejectLogouts)
+    return QString("刷新失败 %1 次, 预期 %2 次")
+        .arg(r.refreshFailures)
+        .arg(s.behavior.rejectLogouts);
+  if (r.sessionsExpired > 2 + s.behavior.rejectLogouts ||
+      r.outagesAvoided == 0)
+    return QString("会话失效 %1 次, 主动刷新避免 %2 次")
+        .arg(r.sessionsExpired)
+        .arg(r.outagesAvoided);
+  return QString();
+}
+
+// 链路恢复后应在一个检测周期加一次退避内重新上线
+QString checkFlapRecovery(const SimScenario &s, const SimResult &r) {
+  qint64 flaps = s.durationMs / s.flapPeriodMs;
+  qint64 limit = flaps * (s.checkIntervalMs + 30 * SECOND) + s.bootMs;
+  if (r.offlineMs > limit)
+    return QString("离线 %1 ms, 预期不超过 %2 ms").arg(r.offlineMs).arg(limit);
+  if (r.loginBlocked)
+    return "链路抖动不应暂停自动登录";
+  return QString();
+}
+
+// 低功耗下常规检测暂停, 链路恢复事件触发的检测应在一次请求往返内重新上线
+QString checkWakeRecovery(const SimScenario &s, const SimResult &r) {
+  qint64 flaps = s.durationMs / s.flapPeriodMs;
+  qint64 perFlap =
+      SECOND + s.behavior.statusLatencyMs + s.behavior.loginLatencyMs;
+  qint64 limit = s.bootMs + flaps * (perFlap + SECOND);
+  if (r.offlineMs > limit)
+    return QString("离线 %1 ms, 预期不超过 %2 ms").arg(r.offlineMs).arg(limit);
+  qint64 normalChecks = s.durationMs / s.checkIntervalMs;
+  if (r.statusRequests * 4 > normalChecks)
+    return QString("状态请求 %1 次, 未因低功耗减少 (常规 %2 次)")
+        .arg(r.statusRequests)
+        .arg(normalChecks);
+  return QString();
+}
+
+// 从在线快照重启: 就绪前即确认在线, 不发出任何登录, 就绪后不重复检测
+QString checkWarmStart(const SimScenario &s, const SimResult &r) {
+  if (r.loginRequests > 0)
+    return QString("会话仍有效却登录 %1 次").arg(r.loginRequests);
+  if (r.knownOnlineMs < 0 || r.knownOnlineMs > s.behavior.statusLatencyMs)
+    return QString("确认在线用时 %1 ms, 预期不超过 %2 ms")
+        .arg(r.knownOnlineMs)
+        .arg(s.behavior.statusLatencyMs);
+  qint64 limit = s.durationMs / s.checkIntervalMs + 1;
+  if (r.statusRequests > limit)
+    return QString("状态请求 %1 次, 预期不超过 %2 次")
+        .arg(r.statusRequests)
+        .arg(limit);
+  return QString();
+}
+
+// 快照确认的状态检测被拦截: 不能因等待确认而错过就绪后的登录
+QString checkStatusRejected(const SimScenario &s, const SimResult &r) {
+  QString error = checkOnlineWithin(s, r);
+  if (!error.isEmpty())
+    return error;
+  if (r.loginRequests != 1)
+    return QString("登录 %1 次, 预期 1 次").arg(r.loginRequests);
+  return QString();
+}
+
+QString checkWrongPassword(const SimScenario &s, const SimResult &r) {
+  Q_UNUSED(s);
+  if (r.loginRequests > 1)
+    return QString("密码错误后仍登录 %1 次").arg(r.loginRequests);
+  if (!r.loginBlocked)
+    return "密码错误应暂停自动登录";
+  return QString();
+}
+
+QList<Case> buildCases(quint32 seed) {
+  QList<Case> cases;
+
+  Case steady;
+  steady.scenario.name = "steady-3d";
+  steady.scenario.durationMs = 3 * DAY;
+  steady.scenario.behavior.sessionLengthMs = DAY;
+  steady.check = checkSessionRecovery;
+  cases << steady;
+
+  Case flapping;
+  flapping.scenario.name = "flapping-1d";
+  flapping.scenario.durationMs = DAY;
+  flapping.scenario.flapPeriodMs = 10 * MINUTE;
+  flapping.scenario.flapDownMs = 30 * SECOND;
+  flapping.check = checkFlapRecovery;
+  cases << flapping;
+
+  Case slow;
+  slow.scenario.name = "slow-portal-1d";
+  slow.scenario.durationMs = DAY;
+  slow.scenario.behavior.statusLatencyMs = 4 * SECOND;
+  slow.scenario.behavior.loginLatencyMs = 8 * SECOND;
+  slow.scenario.behavior.sessionLengthMs = 6 * HOUR;
+  slow.check = checkSessionRecovery;
+  cases << slow;
+
+  Case expiry;
+  expiry.scenario.name = "expiry-2h-2d";
+  expiry.scenario.durationMs = 2 * DAY;
+  expiry.scenario.behavior.sessionLengthMs = 2 * HOUR;
+  expiry.check = checkSessionLearning;
+  cases << expiry;
+
+  Case rejected;
+  rejected.scenario.name = "refresh-rejected-2d";
+  rejected.scenario.durationMs = 2 * DAY;
+  rejected.scenario.behavior.sessionLengthMs = 2 * HOUR;
+  rejected.scenario.behavior.rejectLogouts = 1;
+  rejected.check = checkRefreshRejected;
+  cases << rejected;
+
+  Case lowPower;
+  lowPower.scenario.name = "lowpower-wake-1d";
+  lowPower.scenario.durationMs = DAY;
+  lowPower.scenario.flapPeriodMs = 2 * HOUR;
+  lowPower.scenario.flapDownMs = MINUTE;
+  lowPower.scenario.wakeOnLinkUp = true;
+  lowPower.scenario.lowPower = true;
+  lowPower.check = checkWakeRecovery;
+  cases << lowPower;
+
+  Case warm;
+  warm.scenario.name = "warm-restart-1d";
+  warm.scenario.durationMs = DAY;
+  warm.scenario.behavior.startOnline = true;
+  warm.scenario.warmStart = true;
+  warm.check = checkWarmStart;
+  cases << warm;
+
+  Case verifyRejected;
+  verifyRejected.scenario.name = "status-rejected-1d";
+  verifyRejected.scenario.durationMs = DAY;
+  verifyRejected.scenario.warmStart = true;
+  verifyRejected.scenario.behavior.rejectStatus = 1;
+  verifyRejected.check = checkStatusRejected;
+  cases << verifyRejected;
+
+  Case wrong;
+  wrong.scenario.name = "wrong-password-1d";
+  wrong.scenario.durationMs = DAY;
+  wrong.scenario.behavior.wrongPassword = true;
+  wrong.check = checkWrongPassword;
+  cases << wrong;
+
+  for (Case &c : cases)
+    c.scenario.seed = seed;
+  return cases;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  app.setApplicationName("haut-network-guard-sim");
+  app.setApplicationVersion("1.3.5");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("HAUT Network Guard 断线重连仿真");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  QCommandLineOption seedOption("seed", "重试抖动随机种子", "n", "1");
+  parser.addOption(seedOption);
+  parser.process(app);
+
+  const quint32 seed = parser.value(seedOption).toUInt();
+  int failures = 0;
+
+  out() << QString("%1 %2 %3 %4 %5 %6 %7 %8")
+               .arg("scenario", -18)
+               .arg("status", 7)
+               .arg("login", 6)
+               .arg("online_ms", 10)
+               .arg("offline_s", 10)
+               .arg("outages", 8)
+               .arg("avoided", 8)
+               .arg("wall_us", 8)
+        << Qt::endl;
+
+  for (const Case &c : buildCases(seed)) {
+    const SimResult r = runScenario(c.scenario);
+    const QString error = c.check(c.scenario, r);
+
+    out() << QString("%1 %2 %3 %4 %5 %6 %7 %8")
+                 .arg(c.scenario.name, -18)
+                 .arg(r.statusRequests, 7)
+                 .arg(r.loginRequests, 6)
+                 .arg(r.timeToOnlineMs, 10)
+                 .arg(r.offlineMs / 1000.0, 10, 'f', 1)
+                 .arg(r.outages, 8)
+                 .arg(r.outagesAvoided, 8)
+                 .arg(r.wallUs, 8)
+          << Qt::endl;
+
+    if (!error.isEmpty()) {
+      ++failures;
+      QTextStream(stderr) << c.scenario.name << ": " << error << Qt::endl;
+    }
+  }
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+#include "simulation.h"
+#include "guardcontroller.h"
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+int SimClock::schedule(qint64 delayMs, std::function<void()> callback) {
+  const int id = ++m_nextId;
+  const qint64 due = m_now + qMax<qint64>(0, delayMs);
+  m_queue.emplace(Key(due, id), std::move(callback));
+  m_dueTimes.emplace(id, due);
+  return id;
+}
+
+void SimClock::cancel(int id) {
+  auto it = m_dueTimes.find(id);
+  if (it == m_dueTimes.end())
+    return;
+  m_queue.erase(Key(it->second, id));
+  m_dueTimes.erase(it);
+}
+
+void SimClock::runUntil(qint64 endMs) {
+  while (!m_queue.empty()) {
+    auto first = m_queue.begin();
+    if (first->first.first > endMs)
+      break;
+
+    // 先出队再执行, 回调中可以安全地调度或取消其它事件
+    m_now = first->first.first;
+    m_dueTimes.erase(first->first.second);
+    std::function<void()> callback = std::move(first->second);
+    m_queue.erase(first);
+
+    ++m_processed;
+    callback();
+  }
+  m_now = qMax(m_now, endMs);
+}
+
+SimPortal::SimPortal(SimClock *clock, const Behavior &behavior,
+                     QObject *parent)
+    : GuardTransport(parent), m_clock(clock), m_behavior(behavior) {
+  m_offlineSince = m_clock->nowMs();
+  if (m_behavior.startOnline)
+    setSession(true);
+}
+
+void SimPortal::checkStatus() {
+  if (m_statusRejected < m_behavior.rejectStatus) {
+    ++m_statusRejected;
+    emit requestRejected(Api::Operation::Status, "请求过于频繁, 已限流");
+    return;
+  }
+  m_clock->schedule(m_behavior.statusLatencyMs, [this]() {
+    // 链路断开时请求失败, 与 Api 一样报告离线
+    if (m_linkUp && m_session)
+      emit statusChecked(true, "10.0.0.2", m_bytes,
+                         (m_clock->nowMs() - m_sessionStart) / 1000);
+    else
+      emit statusChecked(false, "", 0, 0);
+  });
+}
+
+void SimPortal::login(const QString &username, const QString &password) {
+  Q_UNUSED(username);
+  Q_UNUSED(password);
+
+  m_clock->schedule(m_behavior.loginLatencyMs, [this]() {
+    if (!m_linkUp) {
+      const PortalError::Info &info = PortalError::network();
+      emit loginFailed(info.message, info.code, info.policy);
+      return;
+    }
+    if (m_behavior.wrongPassword) {
+      const PortalError::Info *info = PortalError::lookup("E2553", 5);
+      emit loginFailed(info->message, info->code, info->policy);
+      return;
+    }
+    setSession(true);
+    emit loginSucceeded("登录成功");
+  });
+}
+
+void SimPortal::logout() {
+  if (m_logoutsRejected < m_behavior.rejectLogouts) {
+    ++m_logoutsRejected;
+    emit requestRejected(Api::Operation::Logout, "请求过于频繁, 已限流");
+    return;
+  }
+  m_clock->schedule(m_behavior.loginLatencyMs, [this]() {
+    setSession(false);
+    emit logoutSucceeded();
+  });
+}
+
+void SimPortal::keepAlive() {
+  if (m_linkUp && m_session)
+    m_bytes += 512;
+}
+
+void SimPortal::setLinkUp(bool up) {
+  if (m_linkUp == up)
+    return;
+
+  if (!up && !m_session)
+    m_offlineMs += m_clock->nowMs() - m_offlineSince;
+  if (!up)
+    setSession(false);
+
+  m_linkUp = up;
+  if (up)
+    m_offlineSince = m_clock->nowMs();
+}
+
+qint64 SimPortal::offlineMs() const {
+  if (m_linkUp && !m_session)
+    return m_offlineMs + m_clock->nowMs() - m_offlineSince;
+  return m_offlineMs;
+}
+
+void SimPortal::setSession(bool online) {
+  if (m_session == online)
+    return;
+
+  const qint64 now = m_clock->nowMs();
+  m_session = online;
+
+  if (online) {
+    if (m_linkUp)
+      m_offlineMs += now - m_offlineSince;
+    if (m_firstOnlineMs < 0)
+      m_firstOnlineMs = now;
+    m_sessionStart = now;
+    if (m_behavior.sessionLengthMs > 0)
+      m_expiryTimer = m_clock->schedule(m_behavior.sessionLengthMs,
+                                        [this]() { expireSession(); });
+    return;
+  }
+
+  m_offlineSince = now;
+  if (m_expiryTimer) {
+    m_clock->cancel(m_expiryTimer);
+    m_expiryTimer = 0;
+  }
+}
+
+void SimPortal::expireSession() {
+  m_expiryTimer = 0;
+  ++m_sessionsExpired;
+  setSession(false);
+}
+
+SimResult runScenario(const SimScenario &scenario) {
+  QElapsedTimer wall;
+  wall.start();
+
+  SimClock clock;
+  SimPortal portal(&clock, scenario.behavior);
+  QRandomGenerator rng(scenario.seed);
+
+  GuardController controller(&clock, &portal);
+  controller.setRandomGenerator(&rng);
+  controller.setCredentials("sim", "sim");
+  controller.setCheckInterval(scenario.checkIntervalMs);
+  if (scenario.lowPower)
+    controller.setLowPowerCheck([]() { return true; });
+
+  if (scenario.warmStart)
+    clock.schedule(0, [&controller]() {
+      controller.start();
+      controller.warmStart();
+    });
+  clock.schedule(scenario.bootMs, [&controller, &scenario]() {
+    if (!scenario.warmStart)
+      controller.start();
+    controller.bootFinished();
+  });
+
+  if (scenario.flapPeriodMs > 0) {
+    for (qint64 t = scenario.flapPeriodMs; t < scenario.durationMs;
+         t += scenario.flapPeriodMs) {
+      clock.schedule(t, [&portal]() { portal.setLinkUp(false); });
+      clock.schedule(t + scenario.flapDownMs,
+                     [&portal]() { portal.setLinkUp(true); });
+      if (scenario.wakeOnLinkUp)
+        clock.schedule(t + scenario.flapDownMs + 1000,
+                       [&controller]() { controller.wake(); });
+    }
+  }
+
+  clock.runUntil(scenario.durationMs);
+  controller.stop();
+
+  SimResult result;
+  const GuardController::Stats &stats = controller.stats();
+  result.statusRequests = stats.statusRequests;
+  result.loginRequests = stats.loginRequests;
+  result.outages = stats.outages;
+  result.refreshes = stats.refreshes;
+  result.refreshFailures = stats.refreshFailures;
+  result.outagesAvoided = stats.outagesAvoided;
+  result.timeToOnlineMs = portal.firstOnlineMs();
+  result.knownOnlineMs = stats.firstOnlineMs;
+  result.offlineMs = portal.offlineMs();
+  result.sessionsExpired = portal.sessionsExpired();
+  result.loginBlocked = controller.autoLoginBlocked();
+  result.events = clock.eventsProcessed();
+  result.wallUs = wall.nsecsElapsed() / 1000;
+  return result;
+}
@@ -0,0 +1,131 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <QObject>
+#include <QString>
+#include <functional>
+#include <map>
+#include <utility>
+
+#include "guardclock.h"
+#include "guardtransport.h"
+
+// 离散事件虚拟时钟: 事件按 (时间, id) 排序, runUntil 直接跳到下一事件,
+// 数天的仿真在毫秒级完成且结果可复现
+class SimClock : public GuardClock {
+public:
+  qint64 nowMs() const override { return m_now; }
+  int schedule(qint64 delayMs, std::function<void()> callback) override;
+  void cancel(int id) override;
+
+  // 依次执行截止 endMs (含) 的全部事件, 最后把时间推进到 endMs
+  void runUntil(qint64 endMs);
+
+  qint64 eventsProcessed() const { return m_processed; }
+
+private:
+  typedef std::pair<qint64, int> Key;
+
+  std::map<Key, std::function<void()>> m_queue;
+  std::map<int, qint64> m_dueTimes;
+  qint64 m_now = 0;
+  qint64 m_processed = 0;
+  int m_nextId = 0;
+};
+
+// 模拟认证服务器与链路: 会话到期、链路中断、响应延迟、密码错误、
+// 请求被拦截, 并统计链路可用而未登录的真实离线时长
+class SimPortal : public GuardTransport {
+  Q_OBJECT
+
+public:
+  struct Behavior {
+    qint64 statusLatencyMs = 50;
+    qint64 loginLatencyMs = 200;
+    qint64 sessionLengthMs = 0; // 会话有效期, 0 表示不过期
+    bool wrongPassword = false;
+    bool startOnline = false;
+    // 前 N 次状态/注销请求被限流/熔断拦截 (与 Api 一样同步发出
+    // requestRejected)
+    int rejectStatus = 0;
+    int rejectLogouts = 0;
+  };
+
+  SimPortal(SimClock *clock, const Behavior &behavior,
+            QObject *parent = nullptr);
+
+  void checkStatus() override;
+  void login(const QString &username, const QString &password) override;
+  void logout() override;
+  void keepAlive() override;
+
+  // 链路通断 (断开时会话同时失效, 对应换 AP/重新获取地址)
+  void setLinkUp(bool up);
+
+  bool sessionOnline() const { return m_session; }
+  // 链路可用但会话离线的累计时长 (截至当前虚拟时间)
+  qint64 offlineMs() const;
+  qint64 firstOnlineMs() const { return m_firstOnlineMs; }
+  qint64 sessionsExpired() const { return m_sessionsExpired; }
+
+private:
+  void setSession(bool online);
+  void expireSession();
+
+  SimClock *m_clock;
+  Behavior m_behavior;
+
+  bool m_linkUp = true;
+  bool m_session = false;
+  int m_expiryTimer = 0;
+  qint64 m_offlineSince = 0;
+  qint64 m_sessionStart = 0;
+  qint64 m_bytes = 0;
+  qint64 m_offlineMs = 0;
+  qint64 m_firstOnlineMs = -1;
+  qint64 m_sessionsExpired = 0;
+  int m_statusRejected = 0;
+  int m_logoutsRejected = 0;
+};
+
+// 一次仿真的场景描述与结果
+struct SimScenario {
+  QString name;
+  qint64 durationMs = 0;
+  qint64 checkIntervalMs = 30000;
+  SimPortal::Behavior behavior;
+
+  // 链路抖动: 每 flapPeriodMs 断开 flapDownMs, 0 表示不抖动
+  qint64 flapPeriodMs = 0;
+  qint64 flapDownMs = 0;
+  // 链路恢复 1 秒后 (获得地址) 通知状态机, 对应网卡/唤醒事件
+  bool wakeOnLinkUp = false;
+  // 全程处于低功耗状态 (显示器关闭/电池供电)
+  bool lowPower = false;
+  // 有上次的状态快照: 启动即检测一次状态确认, 不等待就绪检测
+  bool warmStart = false;
+
+  // 启动就绪检测耗时 (之后状态机开始首次检测)
+  qint64 bootMs = 2000;
+  quint32 seed = 1;
+};
+
+struct SimResult {
+  qint64 statusRequests = 0;
+  qint64 loginRequests = 0;
+  qint64 timeToOnlineMs = -1;
+  qint64 knownOnlineMs = -1; // 状态机首次确认在线的时刻
+  qint64 offlineMs = 0; // 真实离线时长 (链路可用而会话离线)
+  qint64 outages = 0;   // 状态机检测到的掉线次数
+  qint64 refreshes = 0; // 到期前主动刷新次数
+  qint64 refreshFailures = 0;
+  qint64 outagesAvoided = 0;
+  qint64 sessionsExpired = 0;
+  qint64 events = 0;
+  qint64 wallUs = 0;
+  bool loginBlocked = false;
+};
+
+SimResult runScenario(const SimScenario &scenario);
+
+#endif // SIMULATION_H
@@ -0,0 +1,44 @@
+#include "srun3k.h"
+#include <cstring>
+
+const char *const Srun3k::USERNAME_PREFIX = "{SRUN3}\r\n";
+const char *const Srun3k::PASSWORD_KEY = "1234567890";
+
+std::string Srun3k::encryptUsername(const std::string &username) {
+  std::string encrypted(USERNAME_PREFIX);
+  encrypted.reserve(encrypted.size() + username.size());
+  for (char c : username)
+    encrypted.push_back(static_cast<char>(static_cast<unsigned char>(c) + 4));
+  return encrypted;
+}
+
+std::string Srun3k::encryptPassword(const std::string &password) {
+  // 与 Rust/macOS 版本完全一致:
+  // 1. XOR 加密 (密钥反向索引)
+  // 2. 位分割 (低4位 + 0x36, 高4位 + 0x63)
+  // 3. 奇偶交替组合
+  const size_t keyLen = std::strlen(PASSWORD_KEY);
+
+  std::string result;
+  result.reserve(password.size() * 2);
+
+  for (size_t i = 0; i < password.size(); ++i) {
+    unsigned char c = static_cast<unsigned char>(password[i]);
+    unsigned char k =
+        static_cast<unsigned char>(PASSWORD_KEY[keyLen - 1 - (i % keyLen)]);
+    unsigned char ki = c ^ k;
+
+    char lowChar = static_cast<char>((ki & 0x0F) + 0x36);
+    char highChar = static_cast<char>(((ki >> 4) & 0x0F) + 0x63);
+
+    if (i % 2 == 0) {
+      result.push_back(lowChar);
+      result.push_back(highChar);
+    } else {
+      result.push_back(highChar);
+      result.push_back(lowChar);
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,23 @@
+#ifndef SRUN3K_H
+#define SRUN3K_H
+
+#include <string>
+
+// SRUN3K 加密算法的无 Qt 实现, 供 Encryption 与 OpenWrt 原生守护进程共用
+// 输入输出均按单字节处理; Qt 端的用户名按 UTF-16 字符加密 (见 encryption.cpp),
+// 两者只对非 Latin-1 字符与 0xFC 以上的字符结果不同
+class Srun3k {
+public:
+  static const char *const USERNAME_PREFIX;
+
+  // 用户名: 每个字符 + 4，添加前缀
+  static std::string encryptUsername(const std::string &username);
+
+  // 密码: XOR + 位分割
+  static std::string encryptPassword(const std::string &password);
+
+private:
+  static const char *const PASSWORD_KEY;
+};
+
+#endif // SRUN3K_H
@@ -0,0 +1,216 @@
+#include "statesnapshot.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+
+const quint32 StateSnapshot::MAGIC = 0x484E4753; // "HNGS"
+const quint8 StateSnapshot::VERSION = 1;
+// 只有流量/时长变化时最多 10 分钟写一次盘, 退出时再补写
+const qint64 StateSnapshot::SAVE_INTERVAL_MS = 10 * 60 * 1000;
+
+namespace {
+
+void appendString(QByteArray &out, const QString &value) {
+  const QByteArray utf8 = value.toUtf8().left(0xFF);
+  out.append(static_cast<char>(utf8.size()));
+  out.append(utf8);
+}
+
+// 带边界检查的顺序读取
+class Reader {
+public:
+  Reader(const uchar *data, qint64 size) : m_data(data), m_size(size) {}
+
+  bool ok() const { return m_ok; }
+
+  template <typename T> T read() {
+    if (!take(sizeof(T)))
+      return T();
+    return qFromBigEndian<T>(m_data + m_pos - sizeof(T));
+  }
+
+  QByteArray bytes(qint64 length) {
+    if (!take(length))
+      return QByteArray();
+    return QByteArray(reinterpret_cast<const char *>(m_data + m_pos - length),
+                      length);
+  }
+
+  QString string() { return QString::fromUtf8(bytes(read<quint8>())); }
+
+private:
+  bool take(qint64 length) {
+    if (!m_ok || m_pos + length > m_size) {
+      m_ok = false;
+      return false;
+    }
+    m_pos += length;
+    return true;
+  }
+
+  const uchar *m_data;
+  qint64 m_size;
+  qint64 m_pos = 0;
+  bool m_ok = true;
+};
+
+} // namespace
+
+StateSnapshot::StateSnapshot(Api *api, QObject *parent)
+    : QObject(parent), m_api(api), m_path(defaultPath()) {
+  connect(m_api, &Api::statusChecked, this, &StateSnapshot::onStatusChecked);
+  connect(m_api, &Api::loginSuccess, this, &StateSnapshot::onLoginSuccess);
+  connect(m_api, &Api::logoutSuccess, this, &StateSnapshot::onLogoutSuccess);
+}
+
+StateSnapshot::~StateSnapshot() {
+  if (m_dirty)
+    save();
+}
+
+void StateSnapshot::setController(GuardController *controller) {
+  connect(controller, &GuardController::refreshStarted, this,
+          [this]() { m_refreshing = true; });
+  connect(controller, &GuardController::refreshFinished, this,
+          [this]() { m_refreshing = false; });
+}
+
+QString StateSnapshot::defaultPath() {
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+         "/state.bin";
+}
+
+bool StateSnapshot::load() {
+  QFile file(m_path);
+  if (!file.open(QIODevice::ReadOnly) || file.size() == 0)
+    return false;
+
+  // 快照只有几十字节, 直接映射读取, 不经过缓冲区拷贝
+  uchar *data = file.map(0, file.size());
+  if (!data)
+    return false;
+  const bool ok = decode(data, file.size(), &m_state);
+  file.unmap(data);
+  if (!ok) {
+    qWarning() << "状态快照无效, 已忽略:" << m_path;
+    m_state = State();
+    return false;
+  }
+
+  m_stale = true;
+  qInfo() << "已读取状态快照:" << (m_state.status.online ? "在线" : "离线")
+          << "记录于" << ageMs() / 1000 << "秒前";
+  return true;
+}
+
+bool StateSnapshot::restorePortal() {
+  const QUrl current = m_api->profile().statusUrl();
+  if (m_state.portalHost.isEmpty() ||
+      m_state.profile != m_api->profile().name() ||
+      (m_state.portalHost == current.host() &&
+       m_state.portalPort == current.port(80)))
+    return false;
+
+  m_api->setPortal(m_state.portalHost, m_state.portalPort);
+  qInfo() << "使用快照中的认证服务器地址:" << m_state.portalHost << "端口"
+          << m_state.portalPort;
+  return true;
+}
+
+void StateSnapshot::save() {
+  QDir().mkpath(QFileInfo(m_path).absolutePath());
+  QSaveFile file(m_path);
+  const QByteArray data = encode(m_state);
+  if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() ||
+      !file.commit()) {
+    qWarning() << "无法写入状态快照:" << m_path;
+    return;
+  }
+  m_dirty = false;
+  m_savedAt = QDateTime::currentMSecsSinceEpoch();
+}
+
+void StateSnapshot::onStatusChecked(bool online, const QString &ip,
+                                    qint64 bytesUsed, qint64 secondsOnline) {
+  IpcProtocol::StatusSnapshot &status = m_state.status;
+  const QUrl portal = m_api->profile().statusUrl();
+  // 离线结果不代表认证服务器可用, 只在在线时更新地址
+  const bool changed =
+      !status.valid || status.online != online || status.ip != ip ||
+      (online && (portal.host() != m_state.portalHost ||
+                  portal.port(80) != m_state.portalPort));
+
+  status.valid = true;
+  status.online = online;
+  status.ip = ip;
+  status.bytesUsed = bytesUsed;
+  status.secondsOnline = secondsOnline;
+  status.timestamp = QDateTime::currentMSecsSinceEpoch();
+  if (online) {
+    m_state.portalHost = portal.host();
+    m_state.portalPort = portal.port(80);
+    m_state.profile = m_api->profile().name();
+  }
+  m_stale = false;
+
+  if (changed || status.timestamp - m_savedAt >= SAVE_INTERVAL_MS)
+    save();
+  else
+    m_dirty = true;
+}
+
+void StateSnapshot::onLoginSuccess() {
+  // 刷新后的重新登录同样开始了新会话, 照常记录
+  m_state.username = m_api->lastUsername();
+  m_state.loginTimestamp = QDateTime::currentMSecsSinceEpoch();
+  m_dirty = true;
+}
+
+void StateSnapshot::onLogoutSuccess() {
+  if (m_refreshing)
+    return;
+  // 主动注销后下次启动不应显示为在线
+  m_state.status.online = false;
+  m_state.status.timestamp = QDateTime::currentMSecsSinceEpoch();
+  save();
+}
+
+QByteArray StateSnapshot::encode(const State &state) {
+  const QByteArray status = IpcProtocol::encodeStatus(state.status);
+  QByteArray out;
+  char buf[8];
+  qToBigEndian<quint32>(MAGIC, buf);
+  out.append(buf, 4);
+  out.append(static_cast<char>(VERSION));
+  qToBigEndian<quint16>(static_cast<quint16>(status.size()), buf);
+  out.append(buf, 2);
+  out.append(status);
+  qToBigEndian<quint16>(static_cast<quint16>(state.portalPort), buf);
+  out.append(buf, 2);
+  appendString(out, state.portalHost);
+  appendString(out, state.profile);
+  appendString(out, state.username);
+  qToBigEndian<qint64>(state.loginTimestamp, buf);
+  out.append(buf, 8);
+  return out;
+}
+
+bool StateSnapshot::decode(const uchar *data, qint64 size, State *state) {
+  Reader reader(data, size);
+  if (reader.read<quint32>() != MAGIC || reader.read<quint8>() != VERSION)
+    return false;
+
+  const QByteArray status = reader.bytes(reader.read<quint16>());
+  if (!reader.ok() || !IpcProtocol::decodeStatus(status, &state->status))
+    return false;
+  state->portalPort = reader.read<quint16>();
+  state->portalHost = reader.string();
+  state->profile = reader.string();
+  state->username = reader.string();
+  state->loginTimestamp = reader.read<qint64>();
+  return reader.ok();
+}
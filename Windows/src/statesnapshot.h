@@ -0,0 +1,74 @@
+#ifndef STATESNAPSHOT_H
+#define STATESNAPSHOT_H
+
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+
+#include "api.h"
+#include "guardcontroller.h"
+#include "ipcprotocol.h"
+
+// 上次已知状态的二进制快照: 最近一次状态检测结果、可用的认证服务器地址
+// 与最近一次成功登录. 启动时映射读取, 界面立即显示 (标记为过期),
+// 状态机先做一次状态检测确认, 之后才考虑登录.
+// 格式: [u32 魔数][u8 版本][u16 长度][状态负载 (同控制通道)]
+//       [u16 端口][u8 长度][主机]... (主机/配置名/账号各带一字节长度)
+class StateSnapshot : public QObject {
+  Q_OBJECT
+
+public:
+  struct State {
+    IpcProtocol::StatusSnapshot status;
+    QString portalHost; // 最近一次检测成功的认证服务器
+    int portalPort = 0;
+    QString profile;
+    QString username; // 最近一次成功登录
+    qint64 loginTimestamp = 0;
+  };
+
+  explicit StateSnapshot(Api *api, QObject *parent = nullptr);
+  ~StateSnapshot();
+
+  // 状态机主动刷新会话时的注销不记为离线
+  void setController(GuardController *controller);
+
+  // 映射读取快照文件, 文件不存在或格式不符时返回 false
+  bool load();
+  // 快照属于当前门户配置时切换到其中记录的认证服务器
+  bool restorePortal();
+  const State &state() const { return m_state; }
+  // 读取后尚未收到新的状态检测结果
+  bool isStale() const { return m_stale; }
+  qint64 ageMs() const {
+    return QDateTime::currentMSecsSinceEpoch() - m_state.status.timestamp;
+  }
+
+  // 立即写入 (退出时调用); 平时只在状态变化或间隔足够长时写入
+  void save();
+
+  static QString defaultPath();
+  static QByteArray encode(const State &state);
+  static bool decode(const uchar *data, qint64 size, State *state);
+
+private slots:
+  void onStatusChecked(bool online, const QString &ip, qint64 bytesUsed,
+                       qint64 secondsOnline);
+  void onLoginSuccess();
+  void onLogoutSuccess();
+
+private:
+  Api *m_api;
+  QString m_path;
+  State m_state;
+  bool m_stale = false;
+  bool m_dirty = false;
+  bool m_refreshing = false;
+  qint64 m_savedAt = 0;
+
+  static const quint32 MAGIC;
+  static const quint8 VERSION;
+  static const qint64 SAVE_INTERVAL_MS;
+};
+
+#endif // STATESNAPSHOT_H
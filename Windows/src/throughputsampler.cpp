@@ -0,0 +1,217 @@
+#include "throughputsampler.h"
+#include "metrics.h"
+#include "powermonitor.h"
+#include <QDebug>
+#include <QHostAddress>
+#include <QNetworkInterface>
+#include <QUdpSocket>
+#include <cmath>
+
+#ifdef Q_OS_LINUX
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_WIN
+#include <winsock2.h>
+#include <iphlpapi.h>
+#include <netioapi.h>
+#endif
+
+const double ThroughputSampler::EWMA_TAU_MS = 2000.0;
+const double ThroughputSampler::QUIET_RATE = 32 * 1024.0;
+const int ThroughputSampler::RESELECT_SAMPLES = 120;
+
+ThroughputSampler::ThroughputSampler(QObject *parent)
+    : QObject(parent), m_timer(new QTimer(this)) {
+  connect(m_timer, &QTimer::timeout, this, &ThroughputSampler::sample);
+}
+
+ThroughputSampler::~ThroughputSampler() {
+#ifdef Q_OS_LINUX
+  if (m_procFd >= 0)
+    ::close(m_procFd);
+#endif
+}
+
+void ThroughputSampler::start(const QString &host, int intervalMs) {
+#ifdef Q_OS_LINUX
+  if (m_procFd < 0)
+    m_procFd = ::open("/proc/net/dev", O_RDONLY | O_CLOEXEC);
+  if (m_buffer.isEmpty())
+    m_buffer.resize(8192);
+#endif
+  m_host = host;
+  m_clock.start();
+  m_haveSample = false;
+  // 亚秒级采样使用精确定时器保证速率计算稳定, 低频采样允许合并唤醒
+  m_timer->setTimerType(intervalMs < 1000 ? Qt::PreciseTimer
+                                          : Qt::VeryCoarseTimer);
+  m_timer->start(intervalMs);
+  sample();
+}
+
+void ThroughputSampler::stop() { m_timer->stop(); }
+
+bool ThroughputSampler::selectInterface() {
+  m_samplesSinceSelect = 0;
+  m_interfaceIndex = -1;
+
+  // 按路由表找出访问认证服务器时使用的本地地址. UDP 连接不发包,
+  // 对 IP 地址在 connectToHost 内同步完成, 不需要等待
+  QHostAddress local;
+  QHostAddress target(m_host);
+  if (!target.isNull()) {
+    QUdpSocket socket;
+    socket.connectToHost(target, 80);
+    if (socket.state() == QAbstractSocket::ConnectedState)
+      local = socket.localAddress();
+  }
+
+  const auto interfaces = QNetworkInterface::allInterfaces();
+  for (const QNetworkInterface &iface : interfaces) {
+    if (iface.flags() & QNetworkInterface::IsLoopBack)
+      continue;
+    const auto entries = iface.addressEntries();
+    for (const QNetworkAddressEntry &entry : entries) {
+      // 无路由信息时退而选择第一个有 IPv4 地址的网卡
+      bool match =
+          local.isNull()
+              ? entry.ip().protocol() == QAbstractSocket::IPv4Protocol
+              : entry.ip() == local;
+      if (match) {
+        if (iface.name() != m_interfaceName) {
+          // 换网卡后计数器不连续, 重新建立速率和对账基准
+          m_interfaceName = iface.name();
+          m_haveSample = false;
+          m_haveReconcile = false;
+          qInfo() << "吞吐采样网卡:" << m_interfaceName;
+        }
+        m_interfaceIndex = iface.index();
+#ifdef Q_OS_LINUX
+        m_matchKey = m_interfaceName.toLocal8Bit() + ':';
+#endif
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool ThroughputSampler::readCounters(quint64 *rxBytes, quint64 *txBytes) {
+#if defined(Q_OS_LINUX)
+  if (m_procFd < 0)
+    return false;
+  // 网卡很多 (容器/veth) 时一次读不完, 读到文件末尾为止
+  char *buffer = m_buffer.data();
+  qsizetype total = 0;
+  for (;;) {
+    if (total == m_buffer.size() - 1) {
+      m_buffer.resize(m_buffer.size() * 2);
+      buffer = m_buffer.data();
+    }
+    const ssize_t n =
+        ::pread(m_procFd, buffer + total, m_buffer.size() - 1 - total, total);
+    if (n < 0)
+      return false;
+    if (n == 0)
+      break;
+    total += n;
+  }
+  if (total == 0)
+    return false;
+  buffer[total] = '\0';
+
+  // 行格式: "  eth0: 接收 8 列 (首列为字节数) 发送 8 列 (首列为字节数)"
+  const char *line = buffer;
+  while (line && *line) {
+    while (*line == ' ')
+      ++line;
+    if (std::strncmp(line, m_matchKey.constData(), m_matchKey.size()) == 0) {
+      const char *p = line + m_matchKey.size();
+      char *end = nullptr;
+      *rxBytes = std::strtoull(p, &end, 10);
+      p = end;
+      for (int i = 0; i < 7; ++i) {
+        std::strtoull(p, &end, 10);
+        p = end;
+      }
+      *txBytes = std::strtoull(p, &end, 10);
+      return true;
+    }
+    line = std::strchr(line, '\n');
+    if (line)
+      ++line;
+  }
+  return false;
+#elif defined(Q_OS_WIN)
+  MIB_IF_ROW2 row;
+  ZeroMemory(&row, sizeof(row));
+  row.InterfaceIndex = static_cast<NET_IFINDEX>(m_interfaceIndex);
+  if (GetIfEntry2(&row) != NO_ERROR)
+    return false;
+  *rxBytes = row.InOctets;
+  *txBytes = row.OutOctets;
+  return true;
+#else
+  Q_UNUSED(rxBytes);
+  Q_UNUSED(txBytes);
+  return false;
+#endif
+}
+
+void ThroughputSampler::sample() {
+  PowerMonitor::countWakeup();
+  // 定期重新选择网卡, 跟随路由变化 (如切换有线/无线)
+  if (m_interfaceIndex < 0 || ++m_samplesSinceSelect >= RESELECT_SAMPLES) {
+    if (!selectInterface())
+      return;
+  }
+
+  quint64 rx = 0, tx = 0;
+  if (!readCounters(&rx, &tx)) {
+    m_interfaceIndex = -1;
+    return;
+  }
+
+  const qint64 now = m_clock.elapsed();
+  if (m_haveSample && now > m_lastSampleMs && rx >= m_lastRx &&
+      tx >= m_lastTx) {
+    const double dt = now - m_lastSampleMs;
+    const double down = (rx - m_lastRx) * 1000.0 / dt;
+    const double up = (tx - m_lastTx) * 1000.0 / dt;
+
+    // 按实际时间间隔计算平滑系数, 定时器抖动不影响结果
+    const double alpha = 1.0 - std::exp(-dt / EWMA_TAU_MS);
+    m_downRate += alpha * (down - m_downRate);
+    m_upRate += alpha * (up - m_upRate);
+    emit ratesUpdated(m_downRate, m_upRate);
+  }
+
+  m_lastSampleMs = now;
+  m_lastRx = rx;
+  m_lastTx = tx;
+  m_haveSample = true;
+}
+
+void ThroughputSampler::reconcile(bool online, qint64 portalBytes) {
+  if (!online || !m_haveSample) {
+    m_haveReconcile = false;
+    return;
+  }
+
+  const quint64 local = m_lastRx + m_lastTx;
+  if (m_haveReconcile && portalBytes >= m_lastPortalBytes &&
+      local >= m_reconcileLocal) {
+    const qint64 localDelta = static_cast<qint64>(local - m_reconcileLocal);
+    const qint64 portalDelta = portalBytes - m_lastPortalBytes;
+    Metrics::instance().add("throughput_local_bytes", localDelta);
+    Metrics::instance().add("throughput_portal_bytes", portalDelta);
+    emit driftMeasured(localDelta, portalDelta);
+  }
+
+  m_lastPortalBytes = portalBytes;
+  m_reconcileLocal = local;
+  m_haveReconcile = true;
+}
@@ -0,0 +1,74 @@
+#ifndef THROUGHPUTSAMPLER_H
+#define THROUGHPUTSAMPLER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+// 本地网卡吞吐采样: 亚秒级读取网卡计数器 (Linux: /proc/net/dev,
+// Windows: GetIfEntry2), 采样过程不分配内存; 速率做 EWMA 平滑,
+// 并与门户上报的 sum_bytes 增量对账, 发现计费偏差
+class ThroughputSampler : public QObject {
+  Q_OBJECT
+
+public:
+  explicit ThroughputSampler(QObject *parent = nullptr);
+  ~ThroughputSampler();
+
+  // 采样到达 host 所走的网卡
+  void start(const QString &host, int intervalMs = 500);
+  void stop();
+
+  double downRate() const { return m_downRate; } // 字节/秒
+  double upRate() const { return m_upRate; }
+  QString interfaceName() const { return m_interfaceName; }
+  // 低流量时刻 (收发合计低于 QUIET_RATE), 适合短暂中断网络
+  bool isQuiet() const { return m_downRate + m_upRate < QUIET_RATE; }
+
+  // 与门户上报的累计流量对账 (在 statusChecked 时调用)
+  void reconcile(bool online, qint64 portalBytes);
+
+signals:
+  void ratesUpdated(double downRate, double upRate);
+  // 两次门户上报之间, 本地计数器增量与门户增量的对比
+  void driftMeasured(qint64 localBytes, qint64 portalBytes);
+
+private slots:
+  void sample();
+
+private:
+  bool selectInterface();
+  bool readCounters(quint64 *rxBytes, quint64 *txBytes);
+
+  QTimer *m_timer;
+  QString m_host;
+  QString m_interfaceName;
+  int m_interfaceIndex = -1;
+  int m_samplesSinceSelect = 0;
+
+  QElapsedTimer m_clock;
+  qint64 m_lastSampleMs = 0;
+  quint64 m_lastRx = 0;
+  quint64 m_lastTx = 0;
+  bool m_haveSample = false;
+  double m_downRate = 0;
+  double m_upRate = 0;
+
+  // 对账基准
+  bool m_haveReconcile = false;
+  qint64 m_lastPortalBytes = 0;
+  quint64 m_reconcileLocal = 0;
+
+#ifdef Q_OS_LINUX
+  int m_procFd = -1;
+  QByteArray m_buffer; // 读满时加倍, 之后一直复用, 采样时不分配
+  QByteArray m_matchKey; // "eth0:" 形式, 选择网卡时生成
+#endif
+
+  static const double EWMA_TAU_MS;
+  static const double QUIET_RATE;
+  static const int RESELECT_SAMPLES;
+};
+
+#endif // THROUGHPUTSAMPLER_H
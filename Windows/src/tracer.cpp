@@ -0,0 +1,222 @@
+#include "tracer.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QNetworkReply>
+
+// 2^15 个事件约 1.5 MB, 按每个检测周期十余个事件计可覆盖十几个小时
+const int Tracer::CAPACITY = 1 << 15;
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+Tracer &Tracer::instance() {
+  static Tracer instance;
+  return instance;
+}
+
+void Tracer::enable(const QString &path) {
+  if (enabled())
+    return;
+
+  m_events.reset(new Event[CAPACITY]);
+  m_mask = CAPACITY - 1;
+  m_path = path;
+  nowUs(); // 以启用时刻作为时间零点
+  s_enabled.store(true, std::memory_order_release);
+
+  QObject::connect(qApp, &QCoreApplication::aboutToQuit, []() {
+    Tracer &tracer = Tracer::instance();
+    int written = tracer.dump(tracer.m_path);
+    if (written >= 0)
+      qInfo() << "追踪数据已写入" << tracer.m_path << "事件数:" << written;
+  });
+}
+
+qint64 Tracer::nowUs() {
+  static QElapsedTimer timer;
+  static const bool started = (timer.start(), true);
+  Q_UNUSED(started);
+  return timer.nsecsElapsed() / 1000;
+}
+
+quint64 Tracer::nextAsyncId() {
+  return instance().m_asyncId.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+quint32 Tracer::threadId() {
+  static std::atomic<quint32> next{0};
+  thread_local quint32 id = next.fetch_add(1, std::memory_order_relaxed) + 1;
+  return id;
+}
+
+void Tracer::record(char phase, const char *category, const char *name,
+                    qint64 ts, qint64 arg, const char *argName) {
+  // 多个线程各自 fetch_add 领取槽位, 写满后覆盖最旧的事件
+  const quint64 index = m_head.fetch_add(1, std::memory_order_relaxed);
+  Event &event = m_events[index & m_mask];
+  event.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  event.phase = phase;
+  event.category = category;
+  event.name = name;
+  event.argName = argName;
+  event.ts = ts;
+  event.arg = arg;
+  event.tid = threadId();
+  event.seq.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::complete(const char *category, const char *name, qint64 startUs,
+                      qint64 durationUs) {
+  if (enabled())
+    instance().record('X', category, name, startUs, durationUs);
+}
+
+void Tracer::instant(const char *category, const char *name,
+                     const char *argName, qint64 arg) {
+  if (enabled())
+    instance().record('i', category, name, nowUs(), arg, argName);
+}
+
+void Tracer::asyncSpan(const char *category, const char *name, quint64 id,
+                       qint64 startUs, qint64 endUs) {
+  if (!enabled() || startUs < 0 || endUs < startUs)
+    return;
+  Tracer &tracer = instance();
+  tracer.record('b', category, name, startUs, static_cast<qint64>(id));
+  tracer.record('e', category, name, endUs, static_cast<qint64>(id));
+}
+
+void Tracer::traceReply(QNetworkReply *reply, const char *name) {
+  if (!enabled())
+    return;
+
+  // 各阶段的起始时间; 复用已有连接时没有连接阶段
+  struct Phases {
+    qint64 queued = 0;
+    qint64 connecting = -1;
+    qint64 sent = -1;
+    qint64 firstByte = -1;
+  };
+  auto phases = std::make_shared<Phases>();
+  phases->queued = nowUs();
+
+  QObject::connect(reply, &QNetworkReply::socketStartedConnecting, reply,
+                   [phases]() { phases->connecting = nowUs(); });
+  QObject::connect(reply, &QNetworkReply::requestSent, reply,
+                   [phases]() { phases->sent = nowUs(); });
+  QObject::connect(reply, &QNetworkReply::metaDataChanged, reply,
+                   [phases]() {
+                     if (phases->firstByte < 0)
+                       phases->firstByte = nowUs();
+                   });
+  QObject::connect(reply, &QNetworkReply::finished, reply, [phases, name]() {
+    const qint64 end = nowUs();
+    const quint64 id = nextAsyncId();
+    const Phases &p = *phases;
+    // 排队阶段包含代理决策与 DNS; 连接阶段到请求写完为止
+    const qint64 queuedEnd =
+        p.connecting >= 0 ? p.connecting : (p.sent >= 0 ? p.sent : end);
+    const qint64 sentEnd = p.firstByte >= 0 ? p.firstByte : end;
+
+    asyncSpan("api", name, id, p.queued, end);
+    asyncSpan("api", "queued", id, p.queued, queuedEnd);
+    if (p.connecting >= 0)
+      asyncSpan("api", "connect", id, p.connecting,
+                p.sent >= 0 ? p.sent : end);
+    if (p.sent >= 0)
+      asyncSpan("api", "server", id, p.sent, sentEnd);
+    if (p.firstByte >= 0)
+      asyncSpan("api", "download", id, p.firstByte, end);
+  });
+}
+
+int Tracer::dump(const QString &path) const {
+  if (!m_events)
+    return -1;
+
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning() << "无法写入追踪文件:" << path << file.errorString();
+    return -1;
+  }
+
+  const qint64 pid = QCoreApplication::applicationPid();
+  const quint64 head = m_head.load(std::memory_order_acquire);
+  const quint64 capacity = m_mask + 1;
+  const quint64 first = head > capacity ? head - capacity : 0;
+
+  QByteArray out;
+  out.reserve(static_cast<int>((head - first) * 96 + 256));
+  out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  out.append(QString("{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%1,"
+                     "\"args\":{\"name\":\"%2\"}}")
+                 .arg(pid)
+                 .arg(QCoreApplication::applicationName())
+                 .toUtf8());
+
+  int written = 0;
+  for (quint64 index = first; index < head; ++index) {
+    const Event &slot = m_events[index & m_mask];
+    if (slot.seq.load(std::memory_order_acquire) != index + 1)
+      continue; // 尚未写完或已被覆盖
+
+    // 先复制字段再复查序号: 复制期间被写入方覆盖的槽整条丢弃
+    const char phase = slot.phase;
+    const char *category = slot.category;
+    const char *name = slot.name;
+    const char *argName = slot.argName;
+    const qint64 ts = slot.ts;
+    const qint64 arg = slot.arg;
+    const quint32 tid = slot.tid;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != index + 1)
+      continue;
+
+    out.append(",\n{\"ph\":\"");
+    out.append(phase);
+    out.append("\",\"cat\":\"");
+    out.append(category);
+    out.append("\",\"name\":\"");
+    out.append(name);
+    out.append("\",\"pid\":");
+    out.append(QByteArray::number(pid));
+    out.append(",\"tid\":");
+    out.append(QByteArray::number(tid));
+    out.append(",\"ts\":");
+    out.append(QByteArray::number(ts));
+
+    switch (phase) {
+    case 'X':
+      out.append(",\"dur\":");
+      out.append(QByteArray::number(arg));
+      break;
+    case 'b':
+    case 'e':
+      out.append(",\"id\":\"0x");
+      out.append(QByteArray::number(static_cast<quint64>(arg), 16));
+      out.append('"');
+      break;
+    case 'i':
+      out.append(",\"s\":\"t\"");
+      if (argName) {
+        out.append(",\"args\":{\"");
+        out.append(argName);
+        out.append("\":");
+        out.append(QByteArray::number(arg));
+        out.append('}');
+      }
+      break;
+    }
+    out.append('}');
+    ++written;
+  }
+  out.append("\n]}\n");
+
+  if (file.write(out) != out.size()) {
+    qWarning() << "写入追踪文件失败:" << path << file.errorString();
+    return -1;
+  }
+  return written;
+}
@@ -0,0 +1,91 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+class QNetworkReply;
+
+// 请求/决策时间线追踪 (--trace): 事件写入固定大小的无锁环形缓冲,
+// 退出时导出为 Chrome trace-event JSON, 可用 Perfetto 或 chrome://tracing 查看
+// 未启用时每个埋点只有一次原子读, 不分配内存
+// 事件名/分类/参数名须为静态字符串, 缓冲只保存指针
+class Tracer {
+public:
+  static Tracer &instance();
+
+  static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+  // 分配缓冲并开始记录, 应用退出时导出到 path
+  void enable(const QString &path);
+  // 导出为 JSON, 返回写出的事件数, 失败返回 -1
+  int dump(const QString &path) const;
+
+  static qint64 nowUs();
+  static quint64 nextAsyncId();
+
+  // 同步区间 (ph X) 与瞬时事件 (ph i)
+  static void complete(const char *category, const char *name, qint64 startUs,
+                       qint64 durationUs);
+  static void instant(const char *category, const char *name,
+                      const char *argName = nullptr, qint64 arg = 0);
+  // 异步区间 (ph b/e), 同一 id 的区间在同一轨道上嵌套显示
+  static void asyncSpan(const char *category, const char *name, quint64 id,
+                        qint64 startUs, qint64 endUs);
+
+  // 记录一次网络请求的排队、连接、等待服务器、下载各阶段
+  static void traceReply(QNetworkReply *reply, const char *name);
+
+private:
+  struct Event {
+    std::atomic<quint64> seq{0}; // 写完后置为 序号 + 1, 读取时据此丢弃半写的槽
+    char phase = 0;
+    const char *category = nullptr;
+    const char *name = nullptr;
+    const char *argName = nullptr;
+    qint64 ts = 0;
+    qint64 arg = 0; // X 事件为时长, b/e 事件为异步 id
+    quint32 tid = 0;
+  };
+
+  Tracer() = default;
+  ~Tracer() = default;
+
+  void record(char phase, const char *category, const char *name,
+              qint64 ts, qint64 arg, const char *argName = nullptr);
+  static quint32 threadId();
+
+  static std::atomic<bool> s_enabled;
+
+  std::unique_ptr<Event[]> m_events;
+  quint64 m_mask = 0;
+  std::atomic<quint64> m_head{0};
+  std::atomic<quint64> m_asyncId{0};
+  QString m_path;
+
+  static const int CAPACITY;
+};
+
+// 作用域计时: 析构时记录一个同步区间
+class TraceScope {
+public:
+  TraceScope(const char *category, const char *name)
+      : m_category(category), m_name(name),
+        m_startUs(Tracer::enabled() ? Tracer::nowUs() : -1) {}
+  ~TraceScope() {
+    if (m_startUs >= 0)
+      Tracer::complete(m_category, m_name, m_startUs,
+                       Tracer::nowUs() - m_startUs);
+  }
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *m_category;
+  const char *m_name;
+  qint64 m_startUs;
+};
+
+#endif // TRACER_H
@@ -11,6 +11,12 @@ TrayIcon::TrayIcon(QObject *parent) : QObject(parent) {
 
   connect(m_trayIcon, &QSystemTrayIcon::activated, this,
           &TrayIcon::onTrayActivated);
+  connect(m_trayIcon, &QSystemTrayIcon::messageClicked, this, [this]() {
+    if (!m_messageClickable)
+      return;
+    m_messageClickable = false;
+    emit messageClicked();
+  });
 }
 
 void TrayIcon::createMenu() {
@@ -31,6 +37,10 @@ void TrayIcon::createMenu() {
 
   m_menu->addSeparator();
 
+  m_updateAction = m_menu->addAction("检查更新");
+  connect(m_updateAction, &QAction::triggered, this,
+          &TrayIcon::updateRequested);
+
   m_exitAction = m_menu->addAction("退出程序");
   connect(m_exitAction, &QAction::triggered, this, &TrayIcon::exitRequested);
 
@@ -42,16 +52,44 @@ void TrayIcon::show() { m_trayIcon->show(); }
 void TrayIcon::hide() { m_trayIcon->hide(); }
 
 void TrayIcon::setOnlineStatus(bool online) {
+  m_online = online;
   updateIcon(online);
-  m_trayIcon->setToolTip(online ? "HAUT Network Guard - 在线"
-                                : "HAUT Network Guard - 离线");
+  updateToolTip();
+}
+
+void TrayIcon::setThroughput(double downRate, double upRate) {
+  auto format = [](double rate) {
+    if (rate < 1024)
+      return QString("%1 B/s").arg(rate, 0, 'f', 0);
+    if (rate < 1024 * 1024)
+      return QString("%1 KB/s").arg(rate / 1024.0, 0, 'f', 1);
+    return QString("%1 MB/s").arg(rate / (1024.0 * 1024), 0, 'f', 2);
+  };
+  m_throughputText =
+      QString("↓ %1  ↑ %2").arg(format(downRate), format(upRate));
+  updateToolTip();
+}
+
+void TrayIcon::updateToolTip() {
+  QString tip = m_online ? "HAUT Network Guard - 在线"
+                         : "HAUT Network Guard - 离线";
+  if (m_online && !m_throughputText.isEmpty())
+    tip += "\n" + m_throughputText;
+  m_trayIcon->setToolTip(tip);
 }
 
 void TrayIcon::showMessage(const QString &title, const QString &message,
                            QSystemTrayIcon::MessageIcon icon) {
+  m_messageClickable = false;
   m_trayIcon->showMessage(title, message, icon, 3000);
 }
 
+void TrayIcon::showActionMessage(const QString &title,
+                                 const QString &message) {
+  m_messageClickable = true;
+  m_trayIcon->showMessage(title, message, QSystemTrayIcon::Information, 10000);
+}
+
 void TrayIcon::updateIcon(bool online) {
   // 使用应用程序图标
   QIcon icon = QApplication::windowIcon();
@@ -16,15 +16,21 @@ public:
   void hide();
 
   void setOnlineStatus(bool online);
+  // 实时速率 (字节/秒), 显示在提示文字中
+  void setThroughput(double downRate, double upRate);
   void
   showMessage(const QString &title, const QString &message,
               QSystemTrayIcon::MessageIcon icon = QSystemTrayIcon::Information);
+  // 可点击的通知: 用户点击后发出 messageClicked, 被其它通知覆盖后失效
+  void showActionMessage(const QString &title, const QString &message);
 
 signals:
   void showWindowRequested();
   void exitRequested();
   void loginRequested();
   void logoutRequested();
+  void updateRequested();
+  void messageClicked();
 
 private slots:
   void onTrayActivated(QSystemTrayIcon::ActivationReason reason);
@@ -32,13 +38,19 @@ private slots:
 private:
   void createMenu();
   void updateIcon(bool online);
+  void updateToolTip();
 
   QSystemTrayIcon *m_trayIcon;
   QMenu *m_menu;
   QAction *m_showAction;
   QAction *m_loginAction;
   QAction *m_logoutAction;
+  QAction *m_updateAction;
   QAction *m_exitAction;
+
+  bool m_online = false;
+  bool m_messageClickable = false;
+  QString m_throughputText;
 };
 
 #endif // TRAYICON_H
@@ -0,0 +1,524 @@
+#include "updater.h"
+#include "delta.h"
+#include "metrics.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+// 传输超时按无数据时长计, 慢速网络下的大文件不会被误判
+const int Updater::TRANSFER_TIMEOUT_MS = 30000;
+
+namespace {
+
+// 清单中的路径只能指向安装目录内部
+bool isSafePath(const QString &path) {
+  if (path.isEmpty() || QDir::isAbsolutePath(path) ||
+      path.contains(':') || path.contains('\\'))
+    return false;
+  const QString clean = QDir::cleanPath(path);
+  return clean != ".." && !clean.startsWith("../") && !clean.startsWith("/");
+}
+
+// 哈希同时用作暂存文件名, 只接受 64 位小写十六进制
+bool isSha256(const QString &hash) {
+  if (hash.size() != 64)
+    return false;
+  for (const QChar c : hash) {
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+      return false;
+  }
+  return true;
+}
+
+// 清单未签名, 其中的哈希只有经 https 取得才可信; 本机地址允许 http 以便演练
+bool isSecureUrl(const QUrl &url) {
+  if (url.scheme() == "https")
+    return true;
+  const QHostAddress host(url.host());
+  return url.scheme() == "http" &&
+         (url.host() == "localhost" || (!host.isNull() && host.isLoopback()));
+}
+
+// 文件只能从清单所在的源 (协议/主机/端口) 下载
+bool isSameOrigin(const QUrl &url, const QUrl &manifestUrl) {
+  return url.scheme() == manifestUrl.scheme() &&
+         url.host().compare(manifestUrl.host(), Qt::CaseInsensitive) == 0 &&
+         url.port(-1) == manifestUrl.port(-1);
+}
+
+} // namespace
+
+Updater::Updater(QObject *parent)
+    : QObject(parent), m_networkManager(new QNetworkAccessManager(this)),
+      m_installDir(QCoreApplication::applicationDirPath()),
+      m_currentVersion(
+          QVersionNumber::fromString(QCoreApplication::applicationVersion())) {
+  // 未单独设置代理: 更新流量走应用级的 CachingProxyFactory (系统代理 + 缓存)
+}
+
+QNetworkRequest Updater::request(const QUrl &url) {
+  QNetworkRequest request(url);
+  // 重定向不得从 https 降级为 http
+  request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                       QNetworkRequest::NoLessSafeRedirectPolicy);
+  request.setHeader(QNetworkRequest::UserAgentHeader,
+                    "HAUTNetworkGuard/" +
+                        QCoreApplication::applicationVersion());
+  request.setTransferTimeout(TRANSFER_TIMEOUT_MS);
+  return request;
+}
+
+void Updater::check(const QUrl &manifestUrl) {
+  if (isBusy())
+    return;
+
+  m_ready = false;
+  m_jobs.clear();
+  if (!isSecureUrl(manifestUrl)) {
+    // 与网络错误一样异步通知, 调用方可在 check() 之后再进入事件循环
+    const QString error =
+        "更新清单必须通过 https 获取: " + manifestUrl.toString();
+    QMetaObject::invokeMethod(
+        this, [this, error]() { fail(error); }, Qt::QueuedConnection);
+    return;
+  }
+  m_reply = m_networkManager->get(request(manifestUrl));
+  connect(m_reply, &QNetworkReply::finished, this,
+          &Updater::onManifestFinished);
+}
+
+void Updater::onManifestFinished() {
+  QNetworkReply *reply = m_reply;
+  m_reply = nullptr;
+  reply->deleteLater();
+
+  if (reply->error() != QNetworkReply::NoError) {
+    fail("无法获取更新清单: " + reply->errorString());
+    return;
+  }
+
+  // 相对地址按请求的清单地址解析, 不受下载时的重定向影响
+  QString error;
+  if (!parseManifest(reply->readAll(), reply->request().url(), &error)) {
+    fail("更新清单无效: " + error);
+    return;
+  }
+
+  if (m_version <= m_currentVersion || m_jobs.isEmpty()) {
+    emit upToDate();
+    return;
+  }
+
+  qInfo() << "发现新版本" << m_version.toString() << "需更新文件"
+          << m_jobs.size() << "预计下载" << plannedBytes() << "字节, 完整包"
+          << m_fullBytes << "字节";
+  emit updateAvailable(m_version.toString(), m_notes, plannedBytes(),
+                       m_fullBytes);
+}
+
+bool Updater::parseManifest(const QByteArray &data, const QUrl &baseUrl,
+                            QString *error) {
+  QJsonParseError parseError;
+  const QJsonObject manifest =
+      QJsonDocument::fromJson(data, &parseError).object();
+  if (parseError.error != QJsonParseError::NoError) {
+    *error = parseError.errorString();
+    return false;
+  }
+
+  m_version = QVersionNumber::fromString(manifest.value("version").toString());
+  m_notes = manifest.value("notes").toString();
+  if (m_version.isNull()) {
+    *error = "缺少版本号";
+    return false;
+  }
+
+  qint64 totalSize = 0;
+  for (const QJsonValue &value : manifest.value("files").toArray()) {
+    const QJsonObject file = value.toObject();
+    Job job;
+    job.path = file.value("path").toString();
+    job.hash = file.value("sha256").toString().toLower();
+    job.url = baseUrl.resolved(QUrl(file.value("url").toString()));
+    job.size = file.value("size").toInteger();
+    if (!isSafePath(job.path) || !isSha256(job.hash) || job.size < 0) {
+      *error = "文件条目无效: " + job.path;
+      return false;
+    }
+    if (!isSameOrigin(job.url, baseUrl)) {
+      *error = "文件地址与清单不同源: " + job.url.toString();
+      return false;
+    }
+    totalSize += job.size;
+
+    const QString installed =
+        QString::fromLatin1(sha256(QDir(m_installDir).filePath(job.path)));
+    if (installed == job.hash)
+      continue;
+
+    for (const QJsonValue &patchValue : file.value("patches").toArray()) {
+      const QJsonObject patch = patchValue.toObject();
+      if (installed.isEmpty() ||
+          patch.value("from").toString().toLower() != installed)
+        continue;
+      job.patchHash = patch.value("sha256").toString().toLower();
+      job.patchUrl = baseUrl.resolved(QUrl(patch.value("url").toString()));
+      job.patchSize = patch.value("size").toInteger();
+      if (!isSha256(job.patchHash)) {
+        *error = "补丁条目无效: " + job.path;
+        return false;
+      }
+      if (!isSameOrigin(job.patchUrl, baseUrl)) {
+        *error = "补丁地址与清单不同源: " + job.patchUrl.toString();
+        return false;
+      }
+      // 补丁不比完整文件小时没有意义
+      job.usePatch = !job.patchHash.isEmpty() && job.patchSize < job.size;
+      break;
+    }
+    m_jobs.append(job);
+  }
+
+  // 对照基准: 发布页的完整安装包 (压缩包) 大小, 清单未给出时按全部文件计
+  m_fullBytes = manifest.value("package_size").toInteger(totalSize);
+  return true;
+}
+
+qint64 Updater::plannedBytes() const {
+  qint64 bytes = 0;
+  for (const Job &job : m_jobs) {
+    if (QFileInfo::exists(downloadPath(job)))
+      continue;
+    bytes += job.downloadSize() - qMin(job.downloadSize(),
+                                       QFileInfo(partPath(job)).size());
+  }
+  return bytes;
+}
+
+void Updater::download() {
+  if (isBusy() || m_jobs.isEmpty())
+    return;
+
+  m_ready = false;
+  m_current = -1;
+  m_retried = false;
+  m_received = 0;
+  m_total = plannedBytes();
+  m_resumedBytes = 0;
+  for (const Job &job : m_jobs)
+    m_resumedBytes += job.downloadSize();
+  m_resumedBytes -= m_total;
+
+  QDir().mkpath(stagingDir());
+  startNext();
+}
+
+void Updater::cancel() {
+  if (!m_reply)
+    return;
+  // 已下载的部分保留在暂存目录, 下次从断点继续
+  QNetworkReply *reply = m_reply;
+  m_reply = nullptr;
+  reply->disconnect(this);
+  reply->abort();
+  reply->deleteLater();
+  m_file.close();
+}
+
+void Updater::startNext() {
+  if (++m_current >= m_jobs.size()) {
+    m_ready = true;
+    const qint64 downloaded = m_received + m_resumedBytes;
+    Metrics::instance().set("update_bytes_downloaded", downloaded);
+    Metrics::instance().set("update_bytes_saved",
+                            qMax<qint64>(0, m_fullBytes - downloaded));
+    qInfo() << "更新已就绪" << m_version.toString() << "下载" << downloaded
+            << "字节 (其中续传" << m_resumedBytes << "), 完整包" << m_fullBytes
+            << "字节";
+    emit readyToApply(downloaded, m_fullBytes);
+    return;
+  }
+
+  const Job &job = m_jobs.at(m_current);
+  if (QFileInfo::exists(downloadPath(job))) {
+    completeJob();
+    return;
+  }
+
+  m_file.setFileName(partPath(job));
+  if (!m_file.open(QIODevice::Append)) {
+    fail("无法写入暂存目录: " + m_file.fileName());
+    return;
+  }
+  if (m_file.size() >= job.downloadSize()) {
+    m_file.close();
+    QFile::rename(partPath(job), downloadPath(job));
+    completeJob();
+    return;
+  }
+
+  QNetworkRequest range = request(job.downloadUrl());
+  if (m_file.size() > 0)
+    range.setRawHeader("Range",
+                       "bytes=" + QByteArray::number(m_file.size()) + "-");
+  m_rangeChecked = false;
+  m_reply = m_networkManager->get(range);
+  connect(m_reply, &QNetworkReply::readyRead, this, &Updater::onReadyRead);
+  connect(m_reply, &QNetworkReply::finished, this,
+          &Updater::onDownloadFinished);
+}
+
+void Updater::onReadyRead() {
+  const int status =
+      m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  if (status != 200 && status != 206) {
+    m_reply->readAll(); // 错误页面不写入暂存文件
+    return;
+  }
+  if (!m_rangeChecked) {
+    m_rangeChecked = true;
+    // 服务器不支持断点续传时返回 200 与完整内容, 从头写起
+    if (status == 200 && m_file.size() > 0) {
+      m_resumedBytes -= m_file.size();
+      m_total += m_file.size();
+      m_file.resize(0);
+    }
+  }
+
+  const QByteArray data = m_reply->readAll();
+  if (m_file.write(data) != data.size()) {
+    fail("无法写入暂存目录: " + m_file.fileName());
+    return;
+  }
+  m_received += data.size();
+  emit progress(m_received, m_total);
+}
+
+void Updater::onDownloadFinished() {
+  QNetworkReply *reply = m_reply;
+  m_reply = nullptr;
+  reply->deleteLater();
+  m_file.close();
+
+  const Job &job = m_jobs.at(m_current);
+  const int status =
+      reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  // 416: 暂存的部分已是完整内容, 交给哈希校验判断
+  if (reply->error() != QNetworkReply::NoError && status != 416) {
+    fail("下载更新失败: " + reply->errorString());
+    return;
+  }
+
+  QFile::remove(downloadPath(job));
+  QFile::rename(partPath(job), downloadPath(job));
+  completeJob();
+}
+
+void Updater::completeJob() {
+  Job &job = m_jobs[m_current];
+  QString error;
+  if (stageJob(job, &error)) {
+    m_retried = false;
+    startNext();
+    return;
+  }
+
+  QFile::remove(downloadPath(job));
+  --m_current;
+  if (job.usePatch) {
+    // 补丁损坏或与已安装文件不符: 改为下载完整文件
+    qWarning() << "补丁不可用, 改为下载完整文件:" << job.path << error;
+    job.usePatch = false;
+    m_total += job.size;
+    startNext();
+  } else if (!m_retried) {
+    qWarning() << "更新文件校验失败, 重新下载:" << job.path << error;
+    m_retried = true;
+    startNext();
+  } else {
+    fail(error);
+  }
+}
+
+bool Updater::stageJob(const Job &job, QString *error) {
+  const QString source = downloadPath(job);
+  if (QString::fromLatin1(sha256(source)) != job.downloadHash()) {
+    *error = "文件校验失败: " + job.path;
+    return false;
+  }
+
+  const QString staged = stagedPath(job.path);
+  QDir().mkpath(QFileInfo(staged).absolutePath());
+  QFile::remove(staged);
+  if (!job.usePatch) {
+    if (!QFile::copy(source, staged)) {
+      *error = "无法写入暂存目录: " + staged;
+      return false;
+    }
+    return true;
+  }
+
+  QFile oldFile(QDir(m_installDir).filePath(job.path));
+  QFile patchFile(source);
+  if (!oldFile.open(QIODevice::ReadOnly) ||
+      !patchFile.open(QIODevice::ReadOnly)) {
+    *error = "无法读取已安装文件: " + job.path;
+    return false;
+  }
+  QByteArray data;
+  if (!Delta::apply(oldFile.readAll(), patchFile.readAll(), &data, error))
+    return false;
+  if (QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex() !=
+      job.hash.toLatin1()) {
+    *error = "补丁结果校验失败: " + job.path;
+    return false;
+  }
+
+  QSaveFile output(staged);
+  if (!output.open(QIODevice::WriteOnly) || output.write(data) != data.size() ||
+      !output.commit()) {
+    *error = "无法写入暂存目录: " + staged;
+    return false;
+  }
+  return true;
+}
+
+bool Updater::apply(QString *error) {
+  if (!m_ready) {
+    if (error)
+      *error = "更新尚未下载完成";
+    return false;
+  }
+
+  // 先把新文件复制到安装目录 (*.new, 与目标同一卷), 之后只剩改名操作
+  const QDir install(m_installDir);
+  for (const Job &job : m_jobs) {
+    const QString next = install.filePath(job.path) + ".new";
+    QDir().mkpath(QFileInfo(next).absolutePath());
+    QFile::remove(next);
+    if (!QFile::copy(stagedPath(job.path), next)) {
+      for (const Job &written : m_jobs)
+        QFile::remove(install.filePath(written.path) + ".new");
+      if (error)
+        *error = "无法写入安装目录: " + install.absolutePath();
+      return false;
+    }
+  }
+
+  QStringList replacedOld;
+  int replaced = 0;
+  for (; replaced < m_jobs.size(); ++replaced) {
+    const QString target = install.filePath(m_jobs.at(replaced).path);
+    QFile::remove(target + ".old");
+    const bool existed = QFileInfo::exists(target);
+    if (existed && !QFile::rename(target, target + ".old"))
+      break;
+    if (!QFile::rename(target + ".new", target)) {
+      if (existed)
+        QFile::rename(target + ".old", target);
+      break;
+    }
+    if (existed)
+      replacedOld.append(QFileInfo(target + ".old").absoluteFilePath());
+  }
+
+  if (replaced < m_jobs.size()) {
+    // 回滚已替换的文件, 保持旧版本完整可用
+    for (int i = replaced - 1; i >= 0; --i) {
+      const QString target = install.filePath(m_jobs.at(i).path);
+      QFile::remove(target);
+      QFile::rename(target + ".old", target);
+    }
+    for (const Job &job : m_jobs)
+      QFile::remove(install.filePath(job.path) + ".new");
+    if (error)
+      *error = "替换文件失败: " + m_jobs.at(replaced).path;
+    return false;
+  }
+
+  // 只记录本次改名的旧文件, 重启后由 cleanup 按清单删除
+  QFile list(cleanupListPath());
+  QDir().mkpath(QFileInfo(list.fileName()).absolutePath());
+  if (!replacedOld.isEmpty() && list.open(QIODevice::Append | QIODevice::Text))
+    list.write((replacedOld.join('\n') + '\n').toUtf8());
+
+  qInfo() << "已更新到" << m_version.toString();
+  m_ready = false;
+  QDir(stagingDir()).removeRecursively();
+  return true;
+}
+
+void Updater::cleanup(const QString &installDir) {
+  // 上次更新替换下来的旧文件 (运行时被占用, 只能在重启后删除).
+  // 只删除 apply 记录在清单中的路径, 安装目录里其它同名后缀的文件不动
+  QFile list(cleanupListPath());
+  if (!list.open(QIODevice::ReadOnly | QIODevice::Text))
+    return;
+  const QStringList paths =
+      QString::fromUtf8(list.readAll()).split('\n', Qt::SkipEmptyParts);
+  list.close();
+
+  const QString root = QDir(installDir).absolutePath() + "/";
+  QStringList remaining;
+  for (const QString &path : paths) {
+    // 其它安装目录 (如命令行演练) 的记录留给对应的调用
+    if (!path.startsWith(root) ||
+        (QFileInfo::exists(path) && !QFile::remove(path)))
+      remaining.append(path);
+  }
+
+  if (remaining.isEmpty()) {
+    list.remove();
+  } else if (remaining.size() < paths.size()) {
+    QSaveFile output(list.fileName());
+    if (output.open(QIODevice::WriteOnly | QIODevice::Text)) {
+      output.write((remaining.join('\n') + '\n').toUtf8());
+      output.commit();
+    }
+  }
+}
+
+QString Updater::cleanupListPath() {
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+         "/update/cleanup.list";
+}
+
+void Updater::fail(const QString &error) {
+  cancel();
+  qWarning() << error;
+  emit failed(error);
+}
+
+QByteArray Updater::sha256(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly))
+    return QByteArray();
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  hash.addData(&file);
+  return hash.result().toHex();
+}
+
+QString Updater::stagingDir() const {
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+         "/update/" + m_version.toString();
+}
+
+QString Updater::downloadPath(const Job &job) const {
+  return stagingDir() + "/" + job.downloadHash();
+}
+
+QString Updater::partPath(const Job &job) const {
+  return downloadPath(job) + ".part";
+}
+
+QString Updater::stagedPath(const QString &path) const {
+  return stagingDir() + "/files/" + path;
+}
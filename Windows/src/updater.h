@@ -0,0 +1,117 @@
+#ifndef UPDATER_H
+#define UPDATER_H
+
+#include <QFile>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QObject>
+#include <QUrl>
+#include <QVersionNumber>
+
+// 客户端增量更新: 清单列出新版本每个文件的哈希、完整下载地址与
+// 针对旧版本 (按旧文件哈希) 的差分补丁. 与已安装文件相同的跳过,
+// 有匹配补丁的只下载补丁, 否则下载完整文件.
+// 下载断点续传 (Range), 补丁与结果都做 SHA-256 校验, 全部就绪后才替换,
+// 任一文件替换失败整体回滚. 下载量与完整安装包的差额计入 Metrics.
+// 清单必须经 https 获取 (本机地址除外), 文件与补丁必须与清单同源
+class Updater : public QObject {
+  Q_OBJECT
+
+public:
+  explicit Updater(QObject *parent = nullptr);
+
+  // 默认为程序所在目录/当前版本, 命令行工具可指定其它目录做演练
+  void setInstallDir(const QString &dir) { m_installDir = dir; }
+  QString installDir() const { return m_installDir; }
+  void setCurrentVersion(const QVersionNumber &version) {
+    m_currentVersion = version;
+  }
+
+  // 下载清单并与已安装文件比较, 结果通过 updateAvailable/upToDate 通知
+  void check(const QUrl &manifestUrl);
+  // 下载并校验全部所需文件到暂存目录, 完成后发出 readyToApply
+  void download();
+  void cancel();
+  bool isBusy() const { return m_reply != nullptr; }
+
+  // 用暂存的新文件替换已安装文件; 被替换的文件改名为 *.old,
+  // 运行中的程序文件在 Windows 上只能改名不能覆盖, 下次启动时由 cleanup 删除
+  bool apply(QString *error = nullptr);
+  // 删除 apply 记录的旧文件, 没有记录时什么也不做
+  static void cleanup(const QString &installDir);
+
+  QString version() const { return m_version.toString(); }
+  // 本次需要下载的字节数 (已暂存/已续传部分不计) 与完整安装包大小
+  qint64 plannedBytes() const;
+  qint64 fullBytes() const { return m_fullBytes; }
+
+  static QByteArray sha256(const QString &path);
+
+signals:
+  void updateAvailable(const QString &version, const QString &notes,
+                       qint64 downloadBytes, qint64 fullBytes);
+  void upToDate();
+  void progress(qint64 received, qint64 total);
+  void readyToApply(qint64 downloadedBytes, qint64 fullBytes);
+  void failed(const QString &error);
+
+private slots:
+  void onManifestFinished();
+  void onReadyRead();
+  void onDownloadFinished();
+
+private:
+  // 一个需要更新的文件; 下载内容以其哈希命名暂存, 天然支持跨次续传
+  struct Job {
+    QString path; // 相对安装目录的路径
+    QString hash; // 新文件 SHA-256
+    QUrl url;
+    qint64 size = 0;
+    // 匹配已安装版本的补丁, 应用失败时退回完整文件
+    QString patchHash;
+    QUrl patchUrl;
+    qint64 patchSize = 0;
+    bool usePatch = false;
+
+    QString downloadHash() const { return usePatch ? patchHash : hash; }
+    QUrl downloadUrl() const { return usePatch ? patchUrl : url; }
+    qint64 downloadSize() const { return usePatch ? patchSize : size; }
+  };
+
+  static QNetworkRequest request(const QUrl &url);
+  bool parseManifest(const QByteArray &data, const QUrl &baseUrl,
+                     QString *error);
+  void startNext();
+  void completeJob();
+  bool stageJob(const Job &job, QString *error);
+  void fail(const QString &error);
+
+  QString stagingDir() const;
+  QString downloadPath(const Job &job) const;
+  QString partPath(const Job &job) const;
+  QString stagedPath(const QString &path) const;
+  static QString cleanupListPath();
+
+  QNetworkAccessManager *m_networkManager;
+  QNetworkReply *m_reply = nullptr;
+  QFile m_file;
+
+  QString m_installDir;
+  QVersionNumber m_currentVersion;
+  QVersionNumber m_version;
+  QString m_notes;
+  QList<Job> m_jobs;
+  int m_current = -1;
+  bool m_retried = false;
+  bool m_rangeChecked = false;
+  bool m_ready = false;
+  qint64 m_fullBytes = 0;
+  qint64 m_total = 0;
+  qint64 m_received = 0;
+  qint64 m_resumedBytes = 0;
+
+  static const int TRANSFER_TIMEOUT_MS;
+};
+
+#endif // UPDATER_H